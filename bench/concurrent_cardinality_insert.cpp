@@ -0,0 +1,59 @@
+#include <cardinality/concurrent_hyperloglog.h>
+#include <cardinality/concurrent_linear_counter.h>
+#include <hash/mmh3_hash_factory.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+typedef pdstl::concurrent_linear_counter<1 << 24, pdstl::mmh3_hash_factory, uint64_t, uint64_t> linear_counter_type;
+typedef pdstl::concurrent_hyperloglog<14, pdstl::mmh3_hash_factory, uint64_t> hyperloglog_type;
+
+const uint64_t k_ops_per_thread = 1 << 22;
+const uint64_t k_num_items = 1 << 22;
+
+// every thread inserts the same range of items, so counters see each item once per thread
+template <typename C>
+double run(C& a_counter, std::size_t num_threads, std::size_t& estimate) {
+    a_counter.clear();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t index = 0; index < num_threads; ++index) {
+        threads.emplace_back([&a_counter, index]() {
+            for (uint64_t op = 0; op < k_ops_per_thread; ++op) {
+                a_counter.insert((op + index * (k_num_items / 8)) % k_num_items);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    estimate = a_counter.count();
+    return num_threads * k_ops_per_thread / (elapsed.count() / 1000.0);
+}
+
+template <typename C>
+int run_all(C& a_counter, const char* name) {
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        std::size_t estimate = 0;
+        double throughput = run(a_counter, num_threads, estimate);
+        double error = (double(estimate) - double(k_num_items)) / double(k_num_items);
+        std::cout << name << ", " << num_threads << ", " << throughput << ", " << error << std::endl;
+        if (error < -0.05 || error > 0.05) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int /* argc */, char** /*argv*/) {
+    linear_counter_type a_linear_counter(42);
+    hyperloglog_type a_hyperloglog(42);
+    std::cout << "counter, threads, million inserts per second, relative error" << std::endl;
+    return run_all(a_linear_counter, "linear_counter") | run_all(a_hyperloglog, "hyperloglog");
+}
@@ -0,0 +1,60 @@
+#include <hash/mmh3_hash_factory.h>
+#include <membership/concurrent_cuckoo_filter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+typedef pdstl::concurrent_cuckoo_filter<pdstl::cuckoo_table<12, 4, uint32_t>, pdstl::mmh3_hash_factory, uint32_t> filter_type;
+
+const std::size_t k_num_buckets = 1 << 20;
+const uint32_t k_num_items = uint32_t(0.9 * 4 * k_num_buckets);
+const uint32_t k_ops_per_thread = 1 << 22;
+
+// 95% lookups of inserted items, 5% inserts and erases of other items
+double run(filter_type& a_filter, std::size_t num_threads) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    std::vector<char> failed(num_threads, 0);
+    for (std::size_t index = 0; index < num_threads; ++index) {
+        threads.emplace_back([&a_filter, &failed, index]() {
+            uint32_t other = uint32_t(0x80000000u + index * k_ops_per_thread);
+            for (uint32_t op = 0; op < k_ops_per_thread; ++op) {
+                if (op % 20 == 0) {
+                    a_filter.insert(other + op);
+                } else if (op % 20 == 10) {
+                    a_filter.erase(other + op - 10);
+                } else if (!a_filter.contains((op * 2654435761u) % k_num_items + 1)) {
+                    failed[index] = 1;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    bool false_negative = std::find(failed.begin(), failed.end(), 1) != failed.end();
+    return false_negative ? -1 : num_threads * k_ops_per_thread / (elapsed.count() / 1000.0);
+}
+
+int main(int /* argc */, char** /*argv*/) {
+    filter_type a_filter(k_num_buckets, 500);
+    for (uint32_t item = 1; item <= k_num_items; ++item) {
+        a_filter.insert(item);
+    }
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "threads, million operations per second" << std::endl;
+    for (std::size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        double throughput = run(a_filter, num_threads);
+        std::cout << num_threads << ", " << throughput << std::endl;
+        if (throughput < 0) {
+            std::cout << "false negatives found" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <hash/mmh3_hash_factory.h>
+#include <membership/concurrent_quotient_filter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+typedef pdstl::concurrent_quotient_filter<32, 23, pdstl::mmh3_hash_factory, uint32_t> filter_type;
+
+template <typename I>
+double run(uint32_t num_items, std::size_t num_threads, I insert_items) {
+    filter_type a_filter;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t index = 0; index < num_threads; ++index) {
+        threads.emplace_back([&a_filter, &insert_items, index, num_items, num_threads]() {
+            insert_items(a_filter, uint32_t(index * num_items / num_threads + 1), uint32_t((index + 1) * num_items / num_threads + 1));
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    for (uint32_t item = 1; item <= num_items; ++item) {
+        if (!a_filter.contains(item)) {
+            return -1;
+        }
+    }
+    return num_items / (elapsed.count() / 1000.0);
+}
+
+int main(int /* argc */, char** /*argv*/) {
+    const uint32_t k_num_items = uint32_t(0.9 * (1 << 23));
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "threads, million inserts per second, buffered million inserts per second" << std::endl;
+    for (std::size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        double direct = run(k_num_items, num_threads, [](filter_type& a_filter, uint32_t first, uint32_t last) {
+            for (uint32_t item = first; item < last; ++item) {
+                a_filter.insert(item);
+            }
+        });
+        double buffered = run(k_num_items, num_threads, [](filter_type& a_filter, uint32_t first, uint32_t last) {
+            filter_type::insert_buffer buffer(a_filter);
+            for (uint32_t item = first; item < last; ++item) {
+                buffer.insert(item);
+            }
+            buffer.flush();
+        });
+        std::cout << num_threads << ", " << direct << ", " << buffered << std::endl;
+        if (direct < 0 || buffered < 0) {
+            std::cout << "false negatives found" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <hash/mmh3_hash_factory.h>
+#include <membership/cuckoo_filter.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+typedef pdstl::cuckoo_filter<pdstl::cuckoo_table<16, 4, uint32_t>, pdstl::mmh3_hash_factory, uint32_t> filter_type;
+
+int main(int /* argc */, char** /*argv*/) {
+    // 64 MiB of buckets, far larger than the last level cache
+    const std::size_t k_num_buckets = std::size_t(1) << 23;
+    const uint32_t k_num_items = uint32_t(0.5 * 4 * k_num_buckets);
+    const uint32_t k_num_lookups = 1 << 23;
+    filter_type a_filter(k_num_buckets, 500);
+    for (uint32_t item = 1; item <= k_num_items; ++item) {
+        a_filter.insert(item);
+    }
+    // half of the lookups are inserted items
+    std::vector<uint32_t> items(k_num_lookups);
+    for (uint32_t index = 0; index < k_num_lookups; ++index) {
+        items[index] = index % 2 ? index * 2654435761u % k_num_items + 1 : k_num_items + 1 + index;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t found = 0;
+    for (uint32_t item : items) {
+        found += a_filter.contains(item) ? 1 : 0;
+    }
+    auto single = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<bool> result = a_filter.contains(items.cbegin(), items.cend());
+    auto batched = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::size_t batch_found = std::accumulate(result.cbegin(), result.cend(), std::size_t(0));
+
+    std::cout << "single lookup: " << double(single.count()) / k_num_lookups << " ns per item" << std::endl;
+    std::cout << "batched lookup: " << double(batched.count()) / k_num_lookups << " ns per item" << std::endl;
+    if (found != batch_found || found < k_num_lookups / 2) {
+        std::cout << "batched lookup results differ" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include <hash/mmh3_hash_factory.h>
+#include <table/cuckoo_hash_table.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+typedef pdstl::cuckoo_hash_table<32, 4, uint32_t, pdstl::mmh3_hash_factory, uint32_t> table_type;
+
+template <typename F>
+double ns_per_item(uint32_t num_items, F function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return double(elapsed.count()) / num_items;
+}
+
+int main(int /* argc */, char** /*argv*/) {
+    const std::size_t k_num_buckets = std::size_t(1) << 22;
+    const uint32_t k_num_items = uint32_t(0.9 * 4 * k_num_buckets);
+    table_type a_table(k_num_buckets, 500);
+    std::unordered_map<uint32_t, uint32_t> a_map;
+    std::vector<uint32_t> lookups(k_num_items);
+    std::vector<uint32_t> items(k_num_items);
+    for (uint32_t index = 0; index < k_num_items; ++index) {
+        // scattered keys, so std::hash (the identity) gives no locality to std::unordered_map
+        items[index] = (index + 1) * 2654435761u;
+        lookups[index] = (index * 40503u % k_num_items + 1) * 2654435761u;
+    }
+
+    double table_insert = ns_per_item(k_num_items, [&a_table, &items]() {
+        for (uint32_t item : items) {
+            a_table.insert(item, item);
+        }
+    });
+    double map_insert = ns_per_item(k_num_items, [&a_map, &items]() {
+        for (uint32_t item : items) {
+            a_map.emplace(item, item);
+        }
+    });
+    std::size_t mismatches = 0;
+    double table_find = ns_per_item(k_num_items, [&a_table, &lookups, &mismatches]() {
+        for (uint32_t item : lookups) {
+            uint32_t value = 0;
+            mismatches += a_table.find(item, value) && value == item ? 0 : 1;
+        }
+    });
+    double map_find = ns_per_item(k_num_items, [&a_map, &lookups, &mismatches]() {
+        for (uint32_t item : lookups) {
+            auto found = a_map.find(item);
+            mismatches += found != a_map.end() && found->second == item ? 0 : 1;
+        }
+    });
+
+    std::cout << "cuckoo_hash_table: insert " << table_insert << " ns, find " << table_find << " ns, "
+              << double(a_table.capacity() * 2 * sizeof(uint32_t)) / k_num_items << " bytes per item" << std::endl;
+    std::cout << "std::unordered_map: insert " << map_insert << " ns, find " << map_find << " ns" << std::endl;
+    std::cout << "mismatched values: " << mismatches << std::endl;
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <cardinality/hyperloglog.h>
+#include <hash/mmh3_hash_factory.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+template <std::size_t RB>
+using counter_type = pdstl::hyperloglog<14, RB, pdstl::mmh3_hash_factory, uint64_t>;
+
+const std::size_t k_num_counters = 10000;
+// more items than the sparse entries of 8-bit registers can hold (2^14 / 4), so every counter is dense
+const uint64_t k_items_per_counter = 8000;
+const uint64_t k_seed = 42;
+
+// merges dense counters of overlapping ranges of items and estimates the union
+template <std::size_t RB>
+int run() {
+    std::vector<counter_type<RB>> counters;
+    counters.reserve(k_num_counters);
+    for (std::size_t index = 0; index < k_num_counters; ++index) {
+        counters.emplace_back(k_seed);
+        uint64_t first = index * k_items_per_counter / 2;
+        for (uint64_t item = first; item < first + k_items_per_counter; ++item) {
+            counters.back().insert(item);
+        }
+        if (counters.back().is_sparse()) {
+            std::cout << RB << ", counter " << index << " is still sparse" << std::endl;
+            return 1;
+        }
+    }
+    uint64_t expected = (k_num_counters + 1) * k_items_per_counter / 2;
+    auto start = std::chrono::steady_clock::now();
+    counter_type<RB> merged(k_seed);
+    merged.merge(counters.begin(), counters.end());
+    auto merged_time = std::chrono::steady_clock::now();
+    std::size_t estimate = merged.count();
+    auto end = std::chrono::steady_clock::now();
+    auto merge_elapsed = std::chrono::duration_cast<std::chrono::microseconds>(merged_time - start);
+    auto count_elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - merged_time);
+    double error = (double(estimate) - double(expected)) / double(expected);
+    std::cout << RB << ", " << merge_elapsed.count() / 1000.0 << ", " << count_elapsed.count() / 1000.0 << ", " << error << std::endl;
+    return error < -0.05 || error > 0.05 ? 1 : 0;
+}
+
+int main(int /* argc */, char** /*argv*/) {
+    std::cout << "register bits, merge milliseconds, count milliseconds, relative error" << std::endl;
+    return run<6>() | run<8>();
+}
@@ -0,0 +1,47 @@
+#include <hash/mmh3_hash_factory.h>
+#include <membership/quotient_filter.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+int main(int /* argc */, char** /*argv*/) {
+    const uint32_t k_num_items = 1 << 22;
+    const uint32_t k_batch_size = 1 << 18;
+    pdstl::quotient_filter<32, 10, pdstl::mmh3_hash_factory, uint32_t> a_quotient_filter;
+    std::cout << "inserted items, ns per insert" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    auto batch_start = start;
+    for (uint32_t item = 1; item <= k_num_items; ++item) {
+        a_quotient_filter.insert(item);
+        if (item % k_batch_size == 0) {
+            auto now = std::chrono::steady_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - batch_start);
+            std::cout << item << ", " << elapsed.count() / double(k_batch_size) << std::endl;
+            batch_start = now;
+        }
+    }
+    auto total = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "amortised ns per insert: " << total.count() / double(k_num_items) << std::endl;
+
+    uint32_t false_negatives = 0;
+    for (uint32_t item = 1; item <= k_num_items; ++item) {
+        false_negatives += a_quotient_filter.contains(item) ? 0 : 1;
+    }
+    std::cout << "false negatives: " << false_negatives << std::endl;
+
+    std::vector<uint32_t> items(k_num_items);
+    for (uint32_t item = 1; item <= k_num_items; ++item) {
+        items[item - 1] = item;
+    }
+    start = std::chrono::steady_clock::now();
+    pdstl::quotient_filter<32, 10, pdstl::mmh3_hash_factory, uint32_t> bulk_quotient_filter(items.begin(), items.end());
+    total = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "bulk load ns per item: " << total.count() / double(k_num_items) << std::endl;
+    for (uint32_t item = 1; item <= k_num_items; ++item) {
+        false_negatives += bulk_quotient_filter.contains(item) ? 0 : 1;
+    }
+    std::cout << "false negatives after bulk load: " << false_negatives << std::endl;
+    return false_negatives == 0 ? 0 : 1;
+}
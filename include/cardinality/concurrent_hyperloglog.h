@@ -0,0 +1,203 @@
+#ifndef INCLUDE_CARDINALIRT_CONCURRENT_HYPERLOGLOG_H_
+#define INCLUDE_CARDINALIRT_CONCURRENT_HYPERLOGLOG_H_
+
+#include <hash/mmh3_hash_factory.h>
+#include <utils/bits.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cardinality.h"
+#include "hyperloglog.h"
+
+namespace pdstl {
+
+/*! \brief Concurrent HyperLogLog
+ *
+ * concurrent_hyperloglog class implements a HyperLogLog counter which several threads can insert
+ * into and count at the same time without locks. Registers of 6 bits are packed ten to an atomic
+ * 64-bit word. insert raises a register by a compare and swap of its word, and returns without
+ * writing when the register is already at least the rank, which is the case for most inserts once
+ * the registers fill up, so threads rarely contend for cache lines.
+ *
+ * The counter is always dense, there is no sparse mode. Items are hashed and estimated like the
+ * dense mode of hyperloglog with the same seed.
+ *
+ * \tparam P - Number of index bits, 2^P registers, in [4, 18] (default: 14)
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into counter (default: std::string)
+ */
+template <
+    std::size_t P = 14,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string>
+class concurrent_hyperloglog : public cardinality<T> {
+   protected:
+    static constexpr std::size_t k_registers = std::size_t(1) << P;
+    static constexpr std::size_t k_register_bits = 6;
+    static constexpr std::size_t k_max_rank = 64 - P + 1;
+    static constexpr std::size_t k_registers_per_word = 64 / k_register_bits;
+    static constexpr std::size_t k_num_words = (k_registers + k_registers_per_word - 1) / k_registers_per_word;
+
+    std::unique_ptr<HF<T, uint64_t>> hash_factory_;
+    std::unique_ptr<hash<T, uint64_t>> hash_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+
+    //! Rank of \a bits, the number of leading zeros plus one, at most k_max_rank
+    static inline uint8_t rank(uint64_t bits) {
+        return static_cast<uint8_t>(std::min<uint64_t>(count_leading_zeros(bits) + 1, k_max_rank));
+    }
+
+    //! Raises register \a index to \a value if it is lower
+    void update_register(std::size_t index, uint8_t value);
+
+    //! Copies the registers into \a registers, one byte each
+    void unpack_registers(uint8_t* registers) const;
+
+   public:
+    //! Default constructor
+    concurrent_hyperloglog();
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * Counters built with the same seed can be merged.
+     *
+     * \param seed - seed of the hash function
+     */
+    explicit concurrent_hyperloglog(uint64_t seed);
+
+    /*! \brief insert an item into the counter, safe to call from several threads
+     *
+     * \param item - the item to insert into the counter.
+     */
+    void insert(const T& item) override;
+
+    //! \biref clear counter and resets its internal memory, not safe to call during inserts.
+    void clear() override;
+
+    /*! \brief computes and returns cardinality of the inserted items
+     *
+     * Items inserted by other threads during the call may or may not be counted.
+     *
+     * \return cardinality of the inserted items.
+     */
+    std::size_t count() const override;
+
+    /*! \brief Merge items of another counter into this counter.
+     *
+     * Safe to call during inserts into either counter.
+     * Throws std::invalid_argument if the counters use different hash seeds.
+     *
+     * \param other - the counter to merge into this counter.
+     */
+    void merge(const concurrent_hyperloglog& other);
+};
+
+template <std::size_t P, template <typename...> class HF, typename T>
+constexpr std::size_t concurrent_hyperloglog<P, HF, T>::k_registers;
+
+template <std::size_t P, template <typename...> class HF, typename T>
+constexpr std::size_t concurrent_hyperloglog<P, HF, T>::k_register_bits;
+
+template <std::size_t P, template <typename...> class HF, typename T>
+constexpr std::size_t concurrent_hyperloglog<P, HF, T>::k_max_rank;
+
+template <std::size_t P, template <typename...> class HF, typename T>
+constexpr std::size_t concurrent_hyperloglog<P, HF, T>::k_registers_per_word;
+
+template <std::size_t P, template <typename...> class HF, typename T>
+constexpr std::size_t concurrent_hyperloglog<P, HF, T>::k_num_words;
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t P,                      \
+        template <typename...> class HF,    \
+        typename T>                         \
+    __VA_ARGS__ concurrent_hyperloglog<P, HF, T>::method_name
+
+CLASS_METHOD_IMPL(concurrent_hyperloglog, )
+() : hash_factory_(std::make_unique<HF<T, uint64_t>>()), words_(new std::atomic<uint64_t>[k_num_words]) {
+    static_assert(P >= 4 && P <= 18, "Number of index bits must be in [4, 18]");
+    hash_ = hash_factory_->create_hash();
+    clear();
+}
+
+CLASS_METHOD_IMPL(concurrent_hyperloglog, )
+(uint64_t seed) : hash_factory_(std::make_unique<HF<T, uint64_t>>()), words_(new std::atomic<uint64_t>[k_num_words]) {
+    static_assert(P >= 4 && P <= 18, "Number of index bits must be in [4, 18]");
+    hash_ = hash_factory_->create_hash(seed);
+    clear();
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item) {
+    uint64_t hash_value = hash_->value(item);
+    update_register(hash_value >> (64 - P), rank(hash_value << P));
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    for (std::size_t index = 0; index < k_num_words; ++index) {
+        words_[index].store(0, std::memory_order_relaxed);
+    }
+}
+
+CLASS_METHOD_IMPL(count, std::size_t)
+() const {
+    std::vector<uint8_t> registers(k_registers);
+    unpack_registers(registers.data());
+    return static_cast<std::size_t>(std::llround(hyperloglog<P, 8, HF, T>::estimate(registers.data())));
+}
+
+CLASS_METHOD_IMPL(merge, void)
+(const concurrent_hyperloglog& other) {
+    if (hash_->seed() != other.hash_->seed()) {
+        throw std::invalid_argument("HyperLogLog counters with different hash seeds can not be merged.");
+    }
+    for (std::size_t index = 0; index < k_registers; ++index) {
+        uint64_t word = other.words_[index / k_registers_per_word].load(std::memory_order_relaxed);
+        uint64_t value = (word >> (index % k_registers_per_word * k_register_bits)) & bitmask(k_register_bits);
+        if (value != 0) {
+            update_register(index, static_cast<uint8_t>(value));
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(update_register, void)
+(std::size_t index, uint8_t value) {
+    std::atomic<uint64_t>& word = words_[index / k_registers_per_word];
+    std::size_t shift = index % k_registers_per_word * k_register_bits;
+    uint64_t mask = bitmask(k_register_bits) << shift;
+    uint64_t current = word.load(std::memory_order_relaxed);
+    // a failed exchange reloads the word, retry while the register stays below the value
+    while (((current & mask) >> shift) < value) {
+        uint64_t raised = (current & ~mask) | (uint64_t(value) << shift);
+        if (word.compare_exchange_weak(current, raised, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(unpack_registers, void)
+(uint8_t* registers) const {
+    for (std::size_t index = 0; index < k_num_words; ++index) {
+        uint64_t word = words_[index].load(std::memory_order_relaxed);
+        std::size_t first = index * k_registers_per_word;
+        std::size_t last = std::min(first + k_registers_per_word, k_registers);
+        for (std::size_t position = first; position < last; ++position, word >>= k_register_bits) {
+            registers[position] = static_cast<uint8_t>(word & bitmask(k_register_bits));
+        }
+    }
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_CARDINALIRT_CONCURRENT_HYPERLOGLOG_H_
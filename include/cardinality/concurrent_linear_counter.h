@@ -0,0 +1,152 @@
+#ifndef INCLUDE_CARDINALIRT_CONCURRENT_LINEAR_COUNTER_H_
+#define INCLUDE_CARDINALIRT_CONCURRENT_LINEAR_COUNTER_H_
+
+#include <hash/mmh3_hash_factory.h>
+#include <utils/bits.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "cardinality.h"
+
+namespace pdstl {
+
+/*! \brief Concurrent linear counter
+ *
+ * concurrent_linear_counter class implements a linear counter which several threads can insert
+ * into and count at the same time without locks. Bits are kept in atomic 64-bit words and set by
+ * an atomic or, which is skipped when the bit is already set, so inserts of repeated items only
+ * read shared cache lines. Items are hashed like linear_counter with the same seed, so both
+ * estimate the same cardinality.
+ *
+ * \tparam MC - Number of memory bits
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into counter (default: std::string)
+ * \tparam S - Hash output size (default: uint32_t)
+ */
+template <
+    std::size_t MC,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string,
+    typename S = uint32_t>
+class concurrent_linear_counter : public cardinality<T> {
+   private:
+    static constexpr std::size_t k_num_words = (MC + 63) / 64;
+
+    std::unique_ptr<HF<T, S>> hash_factory_;
+    std::unique_ptr<hash<T, S>> hash_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+
+   public:
+    //! Default constructor
+    concurrent_linear_counter();
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * Counters built with the same seed can be merged.
+     *
+     * \param seed - seed of the hash function
+     */
+    explicit concurrent_linear_counter(S seed);
+
+    /*! \brief insert an item into the counter, safe to call from several threads
+     *
+     * \param item - the item to insert into the counter.
+     */
+    void insert(const T& item) override;
+
+    //! \biref clear counter and resets its internal memory, not safe to call during inserts.
+    void clear() override;
+
+    /*! \brief computes and returns cardinality of the inserted items
+     *
+     * Items inserted by other threads during the call may or may not be counted.
+     *
+     * \return cardinality of the inserted items.
+     */
+    std::size_t count() const override;
+
+    /*! \brief Merge items of another counter into this counter, by a bitwise or.
+     *
+     * Safe to call during inserts into either counter.
+     * Throws std::invalid_argument if the counters use different hash seeds.
+     *
+     * \param other - the counter to merge into this counter.
+     */
+    void merge(const concurrent_linear_counter& other);
+};
+
+template <std::size_t MC, template <typename...> class HF, typename T, typename S>
+constexpr std::size_t concurrent_linear_counter<MC, HF, T, S>::k_num_words;
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t MC,                     \
+        template <typename...> class HF,    \
+        typename T,                         \
+        typename S>                         \
+    __VA_ARGS__ concurrent_linear_counter<MC, HF, T, S>::method_name
+
+CLASS_METHOD_IMPL(concurrent_linear_counter, )
+() : hash_factory_(std::make_unique<HF<T, S>>()), words_(new std::atomic<uint64_t>[k_num_words]) {
+    hash_ = hash_factory_->create_hash();
+    clear();
+}
+
+CLASS_METHOD_IMPL(concurrent_linear_counter, )
+(S seed) : hash_factory_(std::make_unique<HF<T, S>>()), words_(new std::atomic<uint64_t>[k_num_words]) {
+    hash_ = hash_factory_->create_hash(seed);
+    clear();
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item) {
+    std::size_t bit = hash_->value(item) % MC;
+    uint64_t mask = uint64_t(1) << (bit % 64);
+    std::atomic<uint64_t>& word = words_[bit / 64];
+    if ((word.load(std::memory_order_relaxed) & mask) == 0) {
+        word.fetch_or(mask, std::memory_order_relaxed);
+    }
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    for (std::size_t index = 0; index < k_num_words; ++index) {
+        words_[index].store(0, std::memory_order_relaxed);
+    }
+}
+
+CLASS_METHOD_IMPL(count, std::size_t)
+() const {
+    std::size_t num_set = 0;
+    for (std::size_t index = 0; index < k_num_words; ++index) {
+        num_set += popcount(words_[index].load(std::memory_order_relaxed));
+    }
+    // estimate of a full counter is unbounded, report the cardinality at one empty bit
+    double m = double(MC);
+    return static_cast<std::size_t>(std::llround(m * std::log(m / std::max<std::size_t>(MC - num_set, 1))));
+}
+
+CLASS_METHOD_IMPL(merge, void)
+(const concurrent_linear_counter& other) {
+    if (hash_->seed() != other.hash_->seed()) {
+        throw std::invalid_argument("Linear counters with different hash seeds can not be merged.");
+    }
+    for (std::size_t index = 0; index < k_num_words; ++index) {
+        uint64_t bits = other.words_[index].load(std::memory_order_relaxed);
+        if ((words_[index].load(std::memory_order_relaxed) & bits) != bits) {
+            words_[index].fetch_or(bits, std::memory_order_relaxed);
+        }
+    }
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_CARDINALIRT_CONCURRENT_LINEAR_COUNTER_H_
@@ -2,9 +2,14 @@
 #define INCLUDE_CARDINALIRT_FM_COUNTER_H_
 
 #include <hash/mmh3_hash_factory.h>
+#include <io/serialization.h>
+#include <utils/bits.h>
 
 #include <bitset>
 #include <cmath>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 #include <string>
 
 #include "cardinality.h"
@@ -12,7 +17,10 @@
 namespace pdstl {
 
 /*! \brief Flajolet–Martin algorithm (a.k.a Probabilistic Counting algorithm with stochastic averaging) for solving cardinality problem
- * 
+ *
+ * Counters built with the same seed can be merged, e.g. partial counts of shards, and save
+ * writes a counter in the versioned format of serialized_header followed by its bits.
+ *
  * \tparam SC - Number of internal simple counters
  * \tparam MC - Number of memory bits
  * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
@@ -28,7 +36,7 @@ template <
 class flajolet_martin_counter : public cardinality<T> {
    private:
     std::unique_ptr<HF<T, S>> hash_factory_;
-    std::unique_ptr<hash<S, S>> hash_;
+    std::unique_ptr<hash<T, S>> hash_;
     std::bitset<MC> bitset_memories_[SC];
 
     static constexpr float phi = 0.77351;
@@ -43,10 +51,21 @@ class flajolet_martin_counter : public cardinality<T> {
         return result;
     }
 
+    //! Header of the counter in the serialized format
+    serialized_header header() const;
+
    public:
     //! Default constructor
     flajolet_martin_counter();
 
+    /*! \brief Constructor with a given hash seed
+     *
+     * Counters built with the same seed can be merged.
+     *
+     * \param seed - seed of the hash function
+     */
+    explicit flajolet_martin_counter(S seed);
+
     /*! \brief insert an item into the counter
      * 
      * \param item - the item to insert into the counter.
@@ -61,6 +80,32 @@ class flajolet_martin_counter : public cardinality<T> {
      * \return cardinality of the inserted items.
      */
     std::size_t count() const override;
+
+    /*! \brief Merge items of another counter into this counter, by a bitwise or of each simple counter.
+     *
+     * The merged counter estimates the cardinality of the union of both sets of items.
+     * Throws std::invalid_argument if the counters use different hash seeds.
+     *
+     * \param other - the counter to merge into this counter.
+     */
+    void merge(const flajolet_martin_counter& other);
+
+    /*! \brief Write the counter to \a out.
+     *
+     * \param out - stream to write to, opened in binary mode.
+     */
+    void save(std::ostream& out) const;
+
+    /*! \brief Read a counter written by save.
+     *
+     * Throws invalid_format_exception if the input is not a counter with the same template
+     * arguments and hash family.
+     *
+     * \param in - stream to read from, opened in binary mode.
+     *
+     * \return the counter, with the hash seed it was saved with.
+     */
+    static flajolet_martin_counter load(std::istream& in);
 };
 
 #define CLASS_METHOD_IMPL(method_name, ...) \
@@ -80,9 +125,20 @@ CLASS_METHOD_IMPL(flajolet_martin_counter, )
     }
 }
 
+CLASS_METHOD_IMPL(flajolet_martin_counter, )
+(S seed) : hash_factory_(std::make_unique<HF<T, S>>()) {
+    hash_ = hash_factory_->create_hash(seed);
+    for (size_t idx = 0; idx < SC; ++idx) {
+        bitset_memories_[idx].reset();
+    }
+}
+
 CLASS_METHOD_IMPL(insert, void)
 (const T& item) {
-    S fingerprint = hash_->value(item) % (1 << MC);
+    S fingerprint = hash_->value(item);
+    if (MC < sizeof(S) * 8) {
+        fingerprint &= static_cast<S>(bitmask(MC));
+    }
     S quotient = fingerprint / SC;
     S remainder = fingerprint % SC;
     bitset_memories_[remainder].set(rank(quotient));
@@ -106,7 +162,46 @@ CLASS_METHOD_IMPL(count, std::size_t)
             }
         }
     }
-    return SC / phi * (1 << (sum / SC));
+    return static_cast<std::size_t>(SC / phi * std::exp2(double(sum) / SC));
+}
+
+CLASS_METHOD_IMPL(merge, void)
+(const flajolet_martin_counter& other) {
+    if (hash_->seed() != other.hash_->seed()) {
+        throw std::invalid_argument("Flajolet-Martin counters with different hash seeds can not be merged.");
+    }
+    for (size_t idx = 0; idx < SC; ++idx) {
+        bitset_memories_[idx] |= other.bitset_memories_[idx];
+    }
+}
+
+CLASS_METHOD_IMPL(save, void)
+(std::ostream& out) const {
+    serialized_header saved = header();
+    write_bytes(out, &saved, sizeof(saved));
+    for (size_t idx = 0; idx < SC; ++idx) {
+        write_bitset(out, bitset_memories_[idx]);
+    }
+}
+
+CLASS_METHOD_IMPL(load, flajolet_martin_counter<SC, MC, HF, T, S>)
+(std::istream& in) {
+    serialized_header saved = read_header(in);
+    flajolet_martin_counter counter(static_cast<S>(saved.seeds[0]));
+    counter.header().check(saved);
+    for (size_t idx = 0; idx < SC; ++idx) {
+        read_bitset(in, counter.bitset_memories_[idx]);
+    }
+    return counter;
+}
+
+CLASS_METHOD_IMPL(header, serialized_header)
+() const {
+    serialized_header saved("fm_counter", hash_factory_->family(), sizeof(S) * 8);
+    saved.seeds[0] = hash_->seed();
+    saved.geometry[0] = SC;
+    saved.geometry[1] = MC;
+    return saved;
 }
 
 #undef CLASS_METHOD_IMPL
@@ -0,0 +1,473 @@
+#ifndef INCLUDE_CARDINALIRT_HYPERLOGLOG_H_
+#define INCLUDE_CARDINALIRT_HYPERLOGLOG_H_
+
+#include <hash/mmh3_hash_factory.h>
+#include <utils/bits.h>
+#include <utils/packed_registers.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cardinality.h"
+
+namespace pdstl {
+
+/*! \brief HyperLogLog++ algorithm for solving cardinality problem
+ *
+ * hyperloglog class implements HyperLogLog (Flajolet et al., "HyperLogLog: the analysis of a
+ * near-optimal cardinality estimation algorithm") with the improvements of HyperLogLog++ (Heule
+ * et al., "HyperLogLog in Practice"). Items are hashed to 64 bits, the first P bits select one of
+ * 2^P registers and the register keeps the maximum rank, one plus the number of leading zeros,
+ * of the remaining bits. The standard error is 1.04 / sqrt(2^P), about 0.8% for P = 14.
+ *
+ * Small cardinalities are kept in sparse mode: a sorted list of (index, rank) pairs at precision
+ * 25, filled through a small unsorted buffer, and estimated by linear counting over 2^25 virtual
+ * registers, which is nearly exact. Once the list takes more memory than the registers, it is
+ * converted to dense mode: 2^P registers of RB bits, either 6 bits packed into 3 * 2^(P-2) bytes
+ * or one byte each, which takes a third more memory but needs no unpacking.
+ *
+ * Dense estimates use the improved estimator of Ertl ("New cardinality estimation algorithms for
+ * HyperLogLog sketches"), which corrects the bias of the raw estimate at small and large
+ * cardinalities analytically from the number of empty and saturated registers, instead of the
+ * empirical bias tables of HyperLogLog++.
+ *
+ * Merges of dense counters and dense estimates run on registers unpacked to bytes, with AVX2 or
+ * AVX-512 when the compiler targets them (see utils/packed_registers.h). Many counters can be
+ * merged in one pass, which keeps a single byte accumulator hot in cache.
+ *
+ * \tparam P - Number of index bits, 2^P registers, in [4, 18] (default: 14)
+ * \tparam RB - Number of bits of each register, 6 or 8 (default: 6)
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into counter (default: std::string)
+ */
+template <
+    std::size_t P = 14,
+    std::size_t RB = 6,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string>
+class hyperloglog : public cardinality<T> {
+   protected:
+    static constexpr std::size_t k_registers = std::size_t(1) << P;
+    static constexpr std::size_t k_register_bits = RB;
+    //! Bytes of the registers, 6-bit registers are padded for vectorised unpacking
+    static constexpr std::size_t k_register_bytes = RB == 8 ? k_registers : packed_registers::packed_size(k_registers) + packed_registers::k_padding;
+    static constexpr std::size_t k_max_rank = 64 - P + 1;
+    static constexpr std::size_t k_sparse_precision = 25;
+    static constexpr std::size_t k_sparse_max_rank = 64 - k_sparse_precision + 1;
+    //! Sparse entries are converted to registers once they take more memory than the registers
+    static constexpr std::size_t k_sparse_limit = k_registers * k_register_bits / 8 / sizeof(uint32_t);
+    static constexpr std::size_t k_buffer_size = k_sparse_limit / 4 + 1;
+
+    std::unique_ptr<HF<T, uint64_t>> hash_factory_;
+    std::unique_ptr<hash<T, uint64_t>> hash_;
+    //! Sparse entries, index at sparse precision above 6 bits of rank, sorted with one entry per index
+    std::vector<uint32_t> sparse_;
+    //! Sparse entries not merged into the sorted list yet
+    std::vector<uint32_t> buffer_;
+    //! Packed registers, empty in sparse mode
+    std::vector<uint8_t> registers_;
+
+    //! Rank of \a bits, the number of leading zeros plus one, at most \a max_rank
+    static inline uint8_t rank(uint64_t bits, std::size_t max_rank) {
+        return static_cast<uint8_t>(std::min<uint64_t>(count_leading_zeros(bits) + 1, max_rank));
+    }
+
+    inline uint8_t get_register(std::size_t index) const {
+        if (RB == 8) {
+            return registers_[index];
+        }
+        std::size_t bit = index * k_register_bits;
+        unsigned word = registers_[bit / 8] | (unsigned(registers_[bit / 8 + 1]) << 8);
+        return static_cast<uint8_t>((word >> (bit % 8)) & bitmask(k_register_bits));
+    }
+
+    inline void set_register(std::size_t index, uint8_t value) {
+        if (RB == 8) {
+            registers_[index] = value;
+            return;
+        }
+        std::size_t bit = index * k_register_bits;
+        unsigned mask = unsigned(bitmask(k_register_bits)) << (bit % 8);
+        unsigned word = registers_[bit / 8] | (unsigned(registers_[bit / 8 + 1]) << 8);
+        word = (word & ~mask) | (unsigned(value) << (bit % 8));
+        registers_[bit / 8] = static_cast<uint8_t>(word);
+        registers_[bit / 8 + 1] = static_cast<uint8_t>(word >> 8);
+    }
+
+    //! Raises register \a index to \a value if it is lower
+    inline void update_register(std::size_t index, uint8_t value) {
+        if (get_register(index) < value) {
+            set_register(index, value);
+        }
+    }
+
+    //! Sparse entry of \a hash_value
+    static inline uint32_t sparse_entry(uint64_t hash_value) {
+        uint64_t index = hash_value >> (64 - k_sparse_precision);
+        return static_cast<uint32_t>((index << 6) | rank(hash_value << k_sparse_precision, k_sparse_max_rank));
+    }
+
+    //! Register \a index and its rank \a value at precision P of sparse entry \a entry
+    static inline void decode_sparse_entry(uint32_t entry, std::size_t& index, uint8_t& value) {
+        constexpr std::size_t k_extra_bits = k_sparse_precision - P;
+        uint32_t sparse_index = entry >> 6;
+        uint64_t extra = sparse_index & bitmask(k_extra_bits);
+        // the rank at precision P counts the extra index bits as leading bits of the rest of the hash
+        value = extra != 0 ? rank(extra << (64 - k_extra_bits), k_max_rank) : static_cast<uint8_t>(k_extra_bits + (entry & bitmask(6)));
+        index = sparse_index >> k_extra_bits;
+    }
+
+    //! Raises the register of sparse entry \a entry to its rank at precision P
+    void apply_sparse_entry(uint32_t entry);
+
+    //! Raises the byte registers \a registers to the ranks of the sparse entries of this counter
+    void max_sparse(uint8_t* registers) const;
+
+    //! Copies the registers of a dense counter into \a registers, one byte each
+    void unpack_registers(uint8_t* registers) const;
+
+    //! Sorts \a entries and merges them into the sorted list, keeping the largest rank of each index
+    void merge_sparse(std::vector<uint32_t>& entries);
+
+    //! Converts the sparse entries to registers
+    void to_dense();
+
+    //! Estimate of a sparse counter, by linear counting over 2^25 registers
+    double sparse_estimate() const;
+
+    //! Estimate of a dense counter
+    double dense_estimate() const;
+
+   public:
+    //! Default constructor
+    hyperloglog();
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * Counters built with the same seed can be merged.
+     *
+     * \param seed - seed of the hash function
+     */
+    explicit hyperloglog(uint64_t seed);
+
+    /*! \brief insert an item into the counter
+     *
+     * \param item - the item to insert into the counter.
+     */
+    void insert(const T& item) override;
+
+    //! \biref clear counter and resets its internal memory.
+    void clear() override;
+
+    /*! \brief computes and returns cardinality of the inserted items
+     *
+     * \return cardinality of the inserted items.
+     */
+    std::size_t count() const override;
+
+    /*! \brief Merge items of another counter into this counter.
+     *
+     * The merged counter estimates the cardinality of the union of both sets of items.
+     * Throws std::invalid_argument if the counters use different hash seeds.
+     *
+     * \param other - the counter to merge into this counter.
+     */
+    void merge(const hyperloglog& other);
+
+    /*! \brief Merge items of many counters into this counter in one pass.
+     *
+     * Registers of the counters are raised into one byte register per index, so the cost is a
+     * vectorised maximum over the registers of each dense counter. Throws std::invalid_argument
+     * if any counter uses a different hash seed.
+     *
+     * \param first - iterator to the first counter to merge.
+     * \param last - iterator past the last counter to merge.
+     */
+    template <typename I>
+    void merge(I first, I last);
+
+    //! \brief Whether the counter is in sparse mode.
+    bool is_sparse() const { return registers_.empty(); }
+
+    /*! \brief Estimate the cardinality of dense registers.
+     *
+     * \param registers - 2^P registers, one byte each, of items hashed like this counter.
+     *
+     * \return estimated cardinality.
+     */
+    static double estimate(const uint8_t* registers);
+};
+
+template <std::size_t P, std::size_t RB, template <typename...> class HF, typename T>
+constexpr std::size_t hyperloglog<P, RB, HF, T>::k_registers;
+
+template <std::size_t P, std::size_t RB, template <typename...> class HF, typename T>
+constexpr std::size_t hyperloglog<P, RB, HF, T>::k_register_bits;
+
+template <std::size_t P, std::size_t RB, template <typename...> class HF, typename T>
+constexpr std::size_t hyperloglog<P, RB, HF, T>::k_register_bytes;
+
+template <std::size_t P, std::size_t RB, template <typename...> class HF, typename T>
+constexpr std::size_t hyperloglog<P, RB, HF, T>::k_max_rank;
+
+template <std::size_t P, std::size_t RB, template <typename...> class HF, typename T>
+constexpr std::size_t hyperloglog<P, RB, HF, T>::k_sparse_precision;
+
+template <std::size_t P, std::size_t RB, template <typename...> class HF, typename T>
+constexpr std::size_t hyperloglog<P, RB, HF, T>::k_sparse_max_rank;
+
+template <std::size_t P, std::size_t RB, template <typename...> class HF, typename T>
+constexpr std::size_t hyperloglog<P, RB, HF, T>::k_sparse_limit;
+
+template <std::size_t P, std::size_t RB, template <typename...> class HF, typename T>
+constexpr std::size_t hyperloglog<P, RB, HF, T>::k_buffer_size;
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t P,                      \
+        std::size_t RB,                     \
+        template <typename...> class HF,    \
+        typename T>                         \
+    __VA_ARGS__ hyperloglog<P, RB, HF, T>::method_name
+
+CLASS_METHOD_IMPL(hyperloglog, )
+() : hash_factory_(std::make_unique<HF<T, uint64_t>>()) {
+    static_assert(P >= 4 && P <= 18, "Number of index bits must be in [4, 18]");
+    static_assert(RB == 6 || RB == 8, "Number of register bits must be 6 or 8");
+    hash_ = hash_factory_->create_hash();
+}
+
+CLASS_METHOD_IMPL(hyperloglog, )
+(uint64_t seed) : hash_factory_(std::make_unique<HF<T, uint64_t>>()) {
+    static_assert(P >= 4 && P <= 18, "Number of index bits must be in [4, 18]");
+    static_assert(RB == 6 || RB == 8, "Number of register bits must be 6 or 8");
+    hash_ = hash_factory_->create_hash(seed);
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item) {
+    uint64_t hash_value = hash_->value(item);
+    if (!is_sparse()) {
+        update_register(hash_value >> (64 - P), rank(hash_value << P, k_max_rank));
+        return;
+    }
+    buffer_.push_back(sparse_entry(hash_value));
+    if (buffer_.size() >= k_buffer_size) {
+        merge_sparse(buffer_);
+        buffer_.clear();
+        if (sparse_.size() > k_sparse_limit) {
+            to_dense();
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    sparse_.clear();
+    buffer_.clear();
+    registers_.clear();
+    registers_.shrink_to_fit();
+}
+
+CLASS_METHOD_IMPL(count, std::size_t)
+() const {
+    return static_cast<std::size_t>(std::llround(is_sparse() ? sparse_estimate() : dense_estimate()));
+}
+
+CLASS_METHOD_IMPL(merge, void)
+(const hyperloglog& other) {
+    merge(&other, &other + 1);
+}
+
+CLASS_METHOD_IMPL(merge, template <typename I> void)
+(I first, I last) {
+    std::size_t num_entries = sparse_.size() + buffer_.size();
+    bool all_sparse = is_sparse();
+    for (I counter = first; counter != last; ++counter) {
+        if (hash_->seed() != counter->hash_->seed()) {
+            throw std::invalid_argument("HyperLogLog counters with different hash seeds can not be merged.");
+        }
+        num_entries += counter->sparse_.size() + counter->buffer_.size();
+        all_sparse = all_sparse && counter->is_sparse();
+    }
+    if (all_sparse && num_entries <= 2 * k_sparse_limit) {
+        std::vector<uint32_t> entries;
+        entries.reserve(num_entries);
+        entries.insert(entries.end(), buffer_.begin(), buffer_.end());
+        for (I counter = first; counter != last; ++counter) {
+            entries.insert(entries.end(), counter->sparse_.begin(), counter->sparse_.end());
+            entries.insert(entries.end(), counter->buffer_.begin(), counter->buffer_.end());
+        }
+        buffer_.clear();
+        merge_sparse(entries);
+        if (sparse_.size() > k_sparse_limit) {
+            to_dense();
+        }
+        return;
+    }
+    std::vector<uint8_t> accumulator(k_registers, 0);
+    if (is_sparse()) {
+        max_sparse(accumulator.data());
+    } else {
+        unpack_registers(accumulator.data());
+    }
+    for (I counter = first; counter != last; ++counter) {
+        if (counter->is_sparse()) {
+            counter->max_sparse(accumulator.data());
+        } else if (RB == 8) {
+            packed_registers::max_bytes(accumulator.data(), counter->registers_.data(), k_registers);
+        } else {
+            packed_registers::max_packed(accumulator.data(), counter->registers_.data(), k_registers);
+        }
+    }
+    registers_.assign(k_register_bytes, 0);
+    if (RB == 8) {
+        std::copy(accumulator.begin(), accumulator.end(), registers_.begin());
+    } else {
+        packed_registers::pack(accumulator.data(), registers_.data(), k_registers);
+    }
+    sparse_.clear();
+    sparse_.shrink_to_fit();
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+}
+
+CLASS_METHOD_IMPL(apply_sparse_entry, void)
+(uint32_t entry) {
+    std::size_t index;
+    uint8_t value;
+    decode_sparse_entry(entry, index, value);
+    update_register(index, value);
+}
+
+CLASS_METHOD_IMPL(max_sparse, void)
+(uint8_t* registers) const {
+    std::size_t index;
+    uint8_t value;
+    for (uint32_t entry : sparse_) {
+        decode_sparse_entry(entry, index, value);
+        registers[index] = std::max(registers[index], value);
+    }
+    for (uint32_t entry : buffer_) {
+        decode_sparse_entry(entry, index, value);
+        registers[index] = std::max(registers[index], value);
+    }
+}
+
+CLASS_METHOD_IMPL(unpack_registers, void)
+(uint8_t* registers) const {
+    if (RB == 8) {
+        std::copy(registers_.begin(), registers_.end(), registers);
+    } else {
+        packed_registers::unpack(registers_.data(), registers, k_registers);
+    }
+}
+
+CLASS_METHOD_IMPL(merge_sparse, void)
+(std::vector<uint32_t>& entries) {
+    std::sort(entries.begin(), entries.end());
+    std::vector<uint32_t> merged;
+    merged.reserve(sparse_.size() + entries.size());
+    std::merge(sparse_.begin(), sparse_.end(), entries.begin(), entries.end(), std::back_inserter(merged));
+    // entries of an index are sorted by rank, keep the last one
+    std::size_t size = 0;
+    for (std::size_t position = 0; position < merged.size(); ++position) {
+        if (position + 1 < merged.size() && (merged[position] >> 6) == (merged[position + 1] >> 6)) {
+            continue;
+        }
+        merged[size++] = merged[position];
+    }
+    merged.resize(size);
+    sparse_.swap(merged);
+}
+
+CLASS_METHOD_IMPL(to_dense, void)
+() {
+    registers_.assign(k_register_bytes, 0);
+    for (uint32_t entry : sparse_) {
+        apply_sparse_entry(entry);
+    }
+    for (uint32_t entry : buffer_) {
+        apply_sparse_entry(entry);
+    }
+    sparse_.clear();
+    sparse_.shrink_to_fit();
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+}
+
+CLASS_METHOD_IMPL(sparse_estimate, double)
+() const {
+    std::vector<uint32_t> indexes;
+    indexes.reserve(sparse_.size() + buffer_.size());
+    for (uint32_t entry : sparse_) {
+        indexes.push_back(entry >> 6);
+    }
+    for (uint32_t entry : buffer_) {
+        indexes.push_back(entry >> 6);
+    }
+    std::sort(indexes.begin(), indexes.end());
+    double num_registers = double(std::size_t(1) << k_sparse_precision);
+    double num_empty = num_registers - double(std::unique(indexes.begin(), indexes.end()) - indexes.begin());
+    return num_registers * std::log(num_registers / num_empty);
+}
+
+CLASS_METHOD_IMPL(dense_estimate, double)
+() const {
+    if (RB == 8) {
+        return estimate(registers_.data());
+    }
+    std::vector<uint8_t> registers(k_registers);
+    unpack_registers(registers.data());
+    return estimate(registers.data());
+}
+
+CLASS_METHOD_IMPL(estimate, double)
+(const uint8_t* registers) {
+    // Ertl's estimator: the sum of 2^-rank of the registers, with empty and saturated registers
+    // replaced by the expectations of their contributions
+    std::size_t num_empty;
+    std::size_t num_saturated;
+    double sum;
+    packed_registers::statistics(registers, k_registers, k_max_rank, num_empty, num_saturated, sum);
+    // the sum covers all registers, 2^-0 of each empty and 2^-k_max_rank of each saturated register
+    sum -= num_empty + num_saturated * std::ldexp(1.0, -static_cast<int>(k_max_rank));
+    double m = double(k_registers);
+    double x = num_empty / m;
+    double sigma = x;
+    if (num_empty == k_registers) {
+        return 0;
+    }
+    for (double y = 1, previous = -1; sigma != previous; y += y) {
+        x *= x;
+        previous = sigma;
+        sigma += x * y;
+    }
+    x = 1 - num_saturated / m;
+    double tau = 0;
+    if (num_saturated > 0 && num_saturated < k_registers) {
+        tau = 1 - x;
+        for (double y = 1, previous = -1; tau != previous;) {
+            x = std::sqrt(x);
+            previous = tau;
+            y *= 0.5;
+            tau -= (1 - x) * (1 - x) * y;
+        }
+        tau /= 3;
+    }
+    double z = m * sigma + sum + m * tau * std::ldexp(1.0, -static_cast<int>(k_max_rank - 1));
+    return m * m / (2 * std::log(2.0) * z);
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_CARDINALIRT_HYPERLOGLOG_H_
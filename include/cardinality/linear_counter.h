@@ -2,9 +2,14 @@
 #define INCLUDE_CARDINALIRT_LINEAR_COUNTER_H_
 
 #include <hash/mmh3_hash_factory.h>
+#include <io/serialization.h>
 
+#include <algorithm>
 #include <bitset>
 #include <cmath>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 #include <string>
 
 #include "cardinality.h"
@@ -12,7 +17,10 @@
 namespace pdstl {
 
 /*! \brief linear counter class for solving cardinality problem
- * 
+ *
+ * Counters built with the same seed can be merged, e.g. partial counts of shards, and save
+ * writes a counter in the versioned format of serialized_header followed by its bits.
+ *
  * \tparam MC - Number of memory bits
  * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
  * \tparam T - Element type which will be inserted into bloom filter (default: std::string)
@@ -26,15 +34,26 @@ template <
 class linear_counter : public cardinality<T> {
    private:
     std::unique_ptr<HF<T, S>> hash_factory_;
-    std::unique_ptr<hash<S, S>> hash_;
+    std::unique_ptr<hash<T, S>> hash_;
     std::bitset<MC> bitset_memory_;
 
+    //! Header of the counter in the serialized format
+    serialized_header header() const;
+
    public:
     //! Default constructor
     linear_counter();
 
+    /*! \brief Constructor with a given hash seed
+     *
+     * Counters built with the same seed can be merged.
+     *
+     * \param seed - seed of the hash function
+     */
+    explicit linear_counter(S seed);
+
     /*! \brief insert an item into the counter
-     * 
+     *
      * \param item - the item to insert into the counter.
      */
     void insert(const T& item) override;
@@ -43,10 +62,36 @@ class linear_counter : public cardinality<T> {
     void clear() override;
 
     /*! \brief computes and returns cardinality of the inserted items
-     * 
+     *
      * \return cardinality of the inserted items.
      */
     std::size_t count() const override;
+
+    /*! \brief Merge items of another counter into this counter, by a bitwise or.
+     *
+     * The merged counter estimates the cardinality of the union of both sets of items.
+     * Throws std::invalid_argument if the counters use different hash seeds.
+     *
+     * \param other - the counter to merge into this counter.
+     */
+    void merge(const linear_counter& other);
+
+    /*! \brief Write the counter to \a out.
+     *
+     * \param out - stream to write to, opened in binary mode.
+     */
+    void save(std::ostream& out) const;
+
+    /*! \brief Read a counter written by save.
+     *
+     * Throws invalid_format_exception if the input is not a counter with the same template
+     * arguments and hash family.
+     *
+     * \param in - stream to read from, opened in binary mode.
+     *
+     * \return the counter, with the hash seed it was saved with.
+     */
+    static linear_counter load(std::istream& in);
 };
 
 #define CLASS_METHOD_IMPL(method_name, ...) \
@@ -63,6 +108,12 @@ CLASS_METHOD_IMPL(linear_counter, )
     bitset_memory_.reset();
 }
 
+CLASS_METHOD_IMPL(linear_counter, )
+(S seed) : hash_factory_(std::make_unique<HF<T, S>>()) {
+    hash_ = hash_factory_->create_hash(seed);
+    bitset_memory_.reset();
+}
+
 CLASS_METHOD_IMPL(insert, void)
 (const T& item) {
     bitset_memory_.set(hash_->value(item) % MC);
@@ -75,7 +126,43 @@ CLASS_METHOD_IMPL(clear, void)
 
 CLASS_METHOD_IMPL(count, std::size_t)
 () const {
-    return -MC * std::log(MC - bitset_memory_.count() / float(MC));
+    std::size_t num_empty = MC - bitset_memory_.count();
+    // estimate of a full counter is unbounded, report the cardinality at one empty bit
+    double m = double(MC);
+    return static_cast<std::size_t>(std::llround(m * std::log(m / std::max<std::size_t>(num_empty, 1))));
+}
+
+CLASS_METHOD_IMPL(merge, void)
+(const linear_counter& other) {
+    if (hash_->seed() != other.hash_->seed()) {
+        throw std::invalid_argument("Linear counters with different hash seeds can not be merged.");
+    }
+    bitset_memory_ |= other.bitset_memory_;
+}
+
+CLASS_METHOD_IMPL(save, void)
+(std::ostream& out) const {
+    serialized_header saved = header();
+    write_bytes(out, &saved, sizeof(saved));
+    write_bitset(out, bitset_memory_);
+}
+
+CLASS_METHOD_IMPL(load, linear_counter<MC, HF, T, S>)
+(std::istream& in) {
+    serialized_header saved = read_header(in);
+    linear_counter counter(static_cast<S>(saved.seeds[0]));
+    counter.header().check(saved);
+    read_bitset(in, counter.bitset_memory_);
+    return counter;
+}
+
+CLASS_METHOD_IMPL(header, serialized_header)
+() const {
+    serialized_header saved("linear_counter", hash_factory_->family(), sizeof(S) * 8);
+    saved.seeds[0] = hash_->seed();
+    saved.geometry[0] = MC;
+    saved.count = bitset_memory_.count();
+    return saved;
 }
 
 #undef CLASS_METHOD_IMPL
@@ -0,0 +1,332 @@
+#ifndef INCLUDE_CARDINALIRT_THETA_SKETCH_H_
+#define INCLUDE_CARDINALIRT_THETA_SKETCH_H_
+
+#include <hash/mmh3_hash_factory.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cardinality.h"
+
+namespace pdstl {
+
+/*! \brief Theta sketch, a K Minimum Values sketch with set operations, for solving cardinality problem
+ *
+ * theta_sketch implements the KMV sketch (Bar-Yossef et al., "Counting distinct elements in a
+ * data stream") in the theta sketch framework (Dasgupta et al., "A Framework for Estimating
+ * Stream Expression Cardinalities"). Items are hashed to 64 bits and the sketch keeps the hashes
+ * below a threshold theta, at most K of them. While fewer than K distinct hashes were seen theta
+ * is 1 and the count is exact; afterwards the count is estimated as the number of kept hashes
+ * divided by theta, as a fraction of the hash range, with a relative standard error of about
+ * 1 / sqrt(K).
+ *
+ * Hashes are kept in an open addressing table of 2K slots allocated at construction. Hashes at
+ * or above theta are rejected by one comparison, so inserts do not allocate. When the table holds
+ * 3K/2 hashes, it is rebuilt with its K smallest hashes, found by quickselect, and theta drops to
+ * the smallest hash removed.
+ *
+ * Sketches built with the same seed support estimates of set expressions: merge keeps the union
+ * of two sketches, intersect their intersection and subtract the difference, each at the smaller
+ * theta of the two sketches.
+ *
+ * \tparam K - Number of kept hashes, a power of two of at least 16 (default: 4096)
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into sketch (default: std::string)
+ */
+template <
+    std::size_t K = 4096,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string>
+class theta_sketch : public cardinality<T> {
+   protected:
+    static constexpr std::size_t k_slots = 2 * K;
+    static constexpr std::size_t k_rebuild_size = K + K / 2;
+    //! Theta of a sketch in exact mode, no hash is rejected
+    static constexpr uint64_t k_max_theta = std::numeric_limits<uint64_t>::max();
+    //! Marks an empty slot, hashes of zero are not kept
+    static constexpr uint64_t k_empty = 0;
+
+    std::unique_ptr<HF<T, uint64_t>> hash_factory_;
+    std::unique_ptr<hash<T, uint64_t>> hash_;
+    //! Upper bound, exclusive, of the kept hashes
+    uint64_t theta_;
+    //! Number of kept hashes
+    std::size_t size_;
+    std::vector<uint64_t> table_;
+    //! Kept hashes gathered by rebuild
+    std::vector<uint64_t> scratch_;
+
+    inline std::size_t slot(uint64_t hash_value) const { return hash_value & (k_slots - 1); }
+
+    //! Whether \a hash_value is kept
+    bool contains(uint64_t hash_value) const;
+
+    //! Keeps \a hash_value unless it is rejected by theta or already kept
+    void insert_hash(uint64_t hash_value);
+
+    //! Keeps the K smallest hashes and lowers theta to the smallest hash removed
+    void rebuild();
+
+    //! Replaces the kept hashes by the \a count hashes of scratch_, all below theta
+    void assign_scratch(std::size_t count);
+
+    //! Throws std::invalid_argument if \a other uses a different hash seed
+    void check_seed(const theta_sketch& other) const;
+
+   public:
+    //! Default constructor
+    theta_sketch();
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * Sketches built with the same seed can be combined by set operations.
+     *
+     * \param seed - seed of the hash function
+     */
+    explicit theta_sketch(uint64_t seed);
+
+    //! Copy constructor, the copy uses the same hash seed
+    theta_sketch(const theta_sketch& other);
+
+    //! Move constructor
+    theta_sketch(theta_sketch&& other) = default;
+
+    //! Copy assignment, the sketch takes the hash seed of \a other
+    theta_sketch& operator=(theta_sketch other);
+
+    /*! \brief insert an item into the sketch
+     *
+     * \param item - the item to insert into the sketch.
+     */
+    void insert(const T& item) override;
+
+    //! \biref clear sketch and resets its internal memory.
+    void clear() override;
+
+    /*! \brief computes and returns cardinality of the inserted items
+     *
+     * \return cardinality of the inserted items.
+     */
+    std::size_t count() const override;
+
+    /*! \brief Keep the union of the items of this sketch and another sketch.
+     *
+     * Throws std::invalid_argument if the sketches use different hash seeds.
+     *
+     * \param other - the sketch to unite with this sketch.
+     */
+    void merge(const theta_sketch& other);
+
+    /*! \brief Keep the intersection of the items of this sketch and another sketch.
+     *
+     * Throws std::invalid_argument if the sketches use different hash seeds.
+     *
+     * \param other - the sketch to intersect with this sketch.
+     */
+    void intersect(const theta_sketch& other);
+
+    /*! \brief Keep the items of this sketch which are not in another sketch.
+     *
+     * Throws std::invalid_argument if the sketches use different hash seeds.
+     *
+     * \param other - the sketch to subtract from this sketch.
+     */
+    void subtract(const theta_sketch& other);
+
+    //! \brief Fraction of the hash range below theta, 1 in exact mode.
+    double theta() const { return theta_ == k_max_theta ? 1.0 : std::ldexp(double(theta_), -64); }
+
+    //! \brief Number of kept hashes.
+    std::size_t size() const { return size_; }
+};
+
+template <std::size_t K, template <typename...> class HF, typename T>
+constexpr std::size_t theta_sketch<K, HF, T>::k_slots;
+
+template <std::size_t K, template <typename...> class HF, typename T>
+constexpr std::size_t theta_sketch<K, HF, T>::k_rebuild_size;
+
+template <std::size_t K, template <typename...> class HF, typename T>
+constexpr uint64_t theta_sketch<K, HF, T>::k_max_theta;
+
+template <std::size_t K, template <typename...> class HF, typename T>
+constexpr uint64_t theta_sketch<K, HF, T>::k_empty;
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t K,                      \
+        template <typename...> class HF,    \
+        typename T>                         \
+    __VA_ARGS__ theta_sketch<K, HF, T>::method_name
+
+CLASS_METHOD_IMPL(theta_sketch, )
+() : hash_factory_(std::make_unique<HF<T, uint64_t>>()), theta_(k_max_theta), size_(0), table_(k_slots, k_empty), scratch_(k_rebuild_size) {
+    static_assert(K >= 16 && (K & (K - 1)) == 0, "Number of kept hashes must be a power of two of at least 16");
+    hash_ = hash_factory_->create_hash();
+}
+
+CLASS_METHOD_IMPL(theta_sketch, )
+(uint64_t seed) : hash_factory_(std::make_unique<HF<T, uint64_t>>()), theta_(k_max_theta), size_(0), table_(k_slots, k_empty), scratch_(k_rebuild_size) {
+    static_assert(K >= 16 && (K & (K - 1)) == 0, "Number of kept hashes must be a power of two of at least 16");
+    hash_ = hash_factory_->create_hash(seed);
+}
+
+CLASS_METHOD_IMPL(theta_sketch, )
+(const theta_sketch& other)
+    : hash_factory_(std::make_unique<HF<T, uint64_t>>()),
+      theta_(other.theta_),
+      size_(other.size_),
+      table_(other.table_),
+      scratch_(k_rebuild_size) {
+    hash_ = hash_factory_->create_hash(other.hash_->seed());
+}
+
+CLASS_METHOD_IMPL(operator=, theta_sketch<K, HF, T>&)
+(theta_sketch other) {
+    std::swap(hash_factory_, other.hash_factory_);
+    std::swap(hash_, other.hash_);
+    std::swap(theta_, other.theta_);
+    std::swap(size_, other.size_);
+    table_.swap(other.table_);
+    scratch_.swap(other.scratch_);
+    return *this;
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item) {
+    insert_hash(hash_->value(item));
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    std::fill(table_.begin(), table_.end(), k_empty);
+    theta_ = k_max_theta;
+    size_ = 0;
+}
+
+CLASS_METHOD_IMPL(count, std::size_t)
+() const {
+    return static_cast<std::size_t>(std::llround(size_ / theta()));
+}
+
+CLASS_METHOD_IMPL(merge, void)
+(const theta_sketch& other) {
+    check_seed(other);
+    if (&other == this) {
+        return;
+    }
+    theta_ = std::min(theta_, other.theta_);
+    std::size_t count = 0;
+    for (uint64_t hash_value : table_) {
+        if (hash_value != k_empty && hash_value < theta_) {
+            scratch_[count++] = hash_value;
+        }
+    }
+    assign_scratch(count);
+    for (uint64_t hash_value : other.table_) {
+        insert_hash(hash_value);
+    }
+}
+
+CLASS_METHOD_IMPL(intersect, void)
+(const theta_sketch& other) {
+    check_seed(other);
+    theta_ = std::min(theta_, other.theta_);
+    std::size_t count = 0;
+    for (uint64_t hash_value : table_) {
+        if (hash_value != k_empty && hash_value < theta_ && other.contains(hash_value)) {
+            scratch_[count++] = hash_value;
+        }
+    }
+    assign_scratch(count);
+}
+
+CLASS_METHOD_IMPL(subtract, void)
+(const theta_sketch& other) {
+    check_seed(other);
+    theta_ = std::min(theta_, other.theta_);
+    std::size_t count = 0;
+    for (uint64_t hash_value : table_) {
+        if (hash_value != k_empty && hash_value < theta_ && !other.contains(hash_value)) {
+            scratch_[count++] = hash_value;
+        }
+    }
+    assign_scratch(count);
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(uint64_t hash_value) const {
+    if (hash_value == k_empty || hash_value >= theta_) {
+        return false;
+    }
+    for (std::size_t index = slot(hash_value);; index = (index + 1) & (k_slots - 1)) {
+        if (table_[index] == hash_value) {
+            return true;
+        }
+        if (table_[index] == k_empty) {
+            return false;
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(insert_hash, void)
+(uint64_t hash_value) {
+    if (hash_value >= theta_ || hash_value == k_empty) {
+        return;
+    }
+    std::size_t index = slot(hash_value);
+    for (; table_[index] != k_empty; index = (index + 1) & (k_slots - 1)) {
+        if (table_[index] == hash_value) {
+            return;
+        }
+    }
+    table_[index] = hash_value;
+    if (++size_ >= k_rebuild_size) {
+        rebuild();
+    }
+}
+
+CLASS_METHOD_IMPL(rebuild, void)
+() {
+    std::size_t count = 0;
+    for (uint64_t hash_value : table_) {
+        if (hash_value != k_empty) {
+            scratch_[count++] = hash_value;
+        }
+    }
+    std::nth_element(scratch_.begin(), scratch_.begin() + K, scratch_.begin() + count);
+    theta_ = scratch_[K];
+    assign_scratch(K);
+}
+
+CLASS_METHOD_IMPL(assign_scratch, void)
+(std::size_t count) {
+    std::fill(table_.begin(), table_.end(), k_empty);
+    size_ = 0;
+    for (std::size_t position = 0; position < count; ++position) {
+        std::size_t index = slot(scratch_[position]);
+        for (; table_[index] != k_empty; index = (index + 1) & (k_slots - 1)) {
+        }
+        table_[index] = scratch_[position];
+        ++size_;
+    }
+}
+
+CLASS_METHOD_IMPL(check_seed, void)
+(const theta_sketch& other) const {
+    if (hash_->seed() != other.hash_->seed()) {
+        throw std::invalid_argument("Theta sketches with different hash seeds can not be combined.");
+    }
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_CARDINALIRT_THETA_SKETCH_H_
@@ -0,0 +1,16 @@
+#ifndef INCLUDE_EXCEPTION_CAPACITY_EXCEEDED_H
+#define INCLUDE_EXCEPTION_CAPACITY_EXCEEDED_H
+
+#include <stdexcept>
+
+namespace pdstl {
+
+//! \brief Exception used when there is no free room left for a new item
+class capacity_exceeded_exception : public std::length_error {
+   public:
+    capacity_exceeded_exception() : std::length_error("Capacity exceeded.") {}
+};
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_EXCEPTION_CAPACITY_EXCEEDED_H
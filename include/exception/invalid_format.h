@@ -0,0 +1,17 @@
+#ifndef INCLUDE_EXCEPTION_INVALID_FORMAT_H
+#define INCLUDE_EXCEPTION_INVALID_FORMAT_H
+
+#include <stdexcept>
+#include <string>
+
+namespace pdstl {
+
+//! \brief Exception used when serialized data is truncated or does not match the structure loading it
+class invalid_format_exception : public std::runtime_error {
+   public:
+    explicit invalid_format_exception(const std::string& what) : std::runtime_error("Invalid format: " + what) {}
+};
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_EXCEPTION_INVALID_FORMAT_H
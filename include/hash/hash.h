@@ -31,6 +31,12 @@ class hash {
      * \return hash value of type \a S
      */
     virtual S value(const T& input) const = 0;
+
+    /*! \brief get seed of this hash
+     *
+     * \return seed used in hash instance creation
+     */
+    S seed() const { return seed_; }
 };
 
 #define CLASS_METHOD_IMPL(method_name, ...) \
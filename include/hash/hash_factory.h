@@ -2,6 +2,7 @@
 #define INCLUDE_HASH_HASH_FACTORY_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "hash.h"
@@ -41,6 +42,15 @@ class hash_factory {
      */
     virtual hash_ptr_vector_t create_hash_vector(std::size_t num) = 0;
 
+    /*! \brief name of the hash family, saved with serialized structures
+     *
+     * Structures are only loaded with a factory of the same family, which must give the same
+     * hash values for the same seeds on every platform.
+     *
+     * \return name of the family, empty if hash values are not stable across platforms
+     */
+    virtual std::string family() const { return std::string(); }
+
     //! default destructor
     virtual ~hash_factory() {}
 };
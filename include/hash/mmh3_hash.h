@@ -50,19 +50,40 @@ CLASS_METHOD_IMPL(~mmh3_hash, )
 #undef CLASS_METHOD_IMPL
 
 template <>
-uint32_t mmh3_hash<std::string, uint32_t>::value(const std::string& input) const {
+inline uint32_t mmh3_hash<std::string, uint32_t>::value(const std::string& input) const {
     uint32_t output;
     MurmurHash3_x86_32(input.c_str(), input.size(), seed_, &output);
     return output;
 }
 
 template <>
-uint32_t mmh3_hash<uint32_t, uint32_t>::value(const uint32_t& input) const {
+inline uint32_t mmh3_hash<uint32_t, uint32_t>::value(const uint32_t& input) const {
     uint32_t output;
     MurmurHash3_x86_32(&input, sizeof(input), seed_, &output);
     return output;
 }
 
+template <>
+inline uint64_t mmh3_hash<std::string, uint64_t>::value(const std::string& input) const {
+    uint64_t output[2];
+    MurmurHash3_x64_128(input.c_str(), input.size(), static_cast<uint32_t>(seed_ ^ (seed_ >> 32)), output);
+    return output[0];
+}
+
+template <>
+inline uint64_t mmh3_hash<uint32_t, uint64_t>::value(const uint32_t& input) const {
+    uint64_t output[2];
+    MurmurHash3_x64_128(&input, sizeof(input), static_cast<uint32_t>(seed_ ^ (seed_ >> 32)), output);
+    return output[0];
+}
+
+template <>
+inline uint64_t mmh3_hash<uint64_t, uint64_t>::value(const uint64_t& input) const {
+    uint64_t output[2];
+    MurmurHash3_x64_128(&input, sizeof(input), static_cast<uint32_t>(seed_ ^ (seed_ >> 32)), output);
+    return output[0];
+}
+
 }   // namespace pdstl
 
 #endif   // INCLUDE_HASH_MMH3_HASH_H_
@@ -4,6 +4,7 @@
 #include <memory>
 #include <random>
 #include <set>
+#include <string>
 
 #include "hash_factory.h"
 #include "mmh3_hash.h"
@@ -44,6 +45,10 @@ class mmh3_hash_factory : public hash_factory<T, S> {
      * @return a vector of unique_ptr of Murmurhash3 objects, all hashes initialized with distinct random seeds
      */
     hash_ptr_vector_t create_hash_vector(std::size_t num) override;
+
+    //! \brief name of the hash family, "murmur3"
+    std::string family() const override { return "murmur3"; }
+
     virtual ~mmh3_hash_factory() {}
 };
 
@@ -71,7 +76,7 @@ CLASS_METHOD_IMPL_TYPED(create_hash_vector, hash_ptr_vector_t)
 (std::size_t num) {
     hash_ptr_vector_t result;
     std::set<S> seeds_set = generate_distinct_random_seeds(num);
-    std::for_each(seeds_set.cbegin(), seeds_set.cend(), [&result](int seed) {
+    std::for_each(seeds_set.cbegin(), seeds_set.cend(), [&result](S seed) {
         result.emplace_back(std::make_unique<mmh3_hash<T, S>>(seed));
     });
     return result;
@@ -0,0 +1,134 @@
+#ifndef INCLUDE_IO_MAPPED_FILE_H_
+#define INCLUDE_IO_MAPPED_FILE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <system_error>
+
+namespace pdstl {
+
+/*! \brief Memory mapped file
+ *
+ * mapped_file class creates a file of a given size, or an anonymous temporary file, and maps it
+ * into memory for reading and writing, or maps an existing file copy-on-write. The mapping is released and the file is
+ * closed on destruction.
+ */
+class mapped_file {
+   private:
+    int fd_;
+    void* data_;
+    std::size_t size_;
+
+    [[noreturn]] static void throw_system_error(const std::string& path) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    //! Sizes the open file and maps it for reading and writing, closes it on failure
+    void map_shared(const std::string& path) {
+        if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+            ::close(fd_);
+            throw_system_error(path);
+        }
+        data_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (data_ == MAP_FAILED) {
+            ::close(fd_);
+            throw_system_error(path);
+        }
+    }
+
+    //! Takes an open file \a fd and maps it, \a path only names it in errors
+    mapped_file(int fd, std::size_t size, const std::string& path) : fd_(fd), data_(nullptr), size_(size) {
+        map_shared(path);
+    }
+
+   public:
+    /*! \brief Creates (or truncates) a zero-filled file and maps it for reading and writing
+     *
+     * \param path - path of the file.
+     * \param size - size of the file in bytes.
+     */
+    mapped_file(const std::string& path, std::size_t size) : fd_(-1), data_(nullptr), size_(size) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) {
+            throw_system_error(path);
+        }
+        map_shared(path);
+    }
+
+    /*! \brief Creates an anonymous zero-filled file in a directory and maps it for reading and writing
+     *
+     * The file is created under a unique name by mkstemp, which never opens an existing file or
+     * follows a symbolic link, and is unlinked before it is sized and mapped, so it is removed
+     * when the mapping is released, or on failure, and no other process can open it by name.
+     *
+     * \param directory - directory of the file.
+     * \param size - size of the file in bytes.
+     *
+     * \return the mapped file.
+     */
+    static std::unique_ptr<mapped_file> create_temporary(const std::string& directory, std::size_t size) {
+        std::string path = directory + "/pdstl_XXXXXX";
+        int fd = ::mkstemp(&path[0]);
+        if (fd < 0) {
+            throw_system_error(directory);
+        }
+        ::unlink(path.c_str());
+        return std::unique_ptr<mapped_file>(new mapped_file(fd, size, path));
+    }
+
+    /*! \brief Maps an existing file copy-on-write
+     *
+     * Pages are read from the file on first access and shared with other processes mapping the
+     * file, until they are written: writes go to private copies and never reach the file.
+     *
+     * \param path - path of the file.
+     */
+    explicit mapped_file(const std::string& path) : fd_(-1), data_(nullptr), size_(0) {
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw_system_error(path);
+        }
+        off_t size = ::lseek(fd_, 0, SEEK_END);
+        if (size < 0) {
+            ::close(fd_);
+            throw_system_error(path);
+        }
+        size_ = static_cast<std::size_t>(size);
+        data_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_, 0);
+        if (data_ == MAP_FAILED) {
+            ::close(fd_);
+            throw_system_error(path);
+        }
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    //! Unmaps and closes the file
+    ~mapped_file() {
+        ::munmap(data_, size_);
+        ::close(fd_);
+    }
+
+    //! \brief Mapped memory of the file
+    void* data() const { return data_; }
+
+    //! \brief Size of the file in bytes
+    std::size_t size() const { return size_; }
+
+    //! \brief Advise the kernel that the file will be read sequentially
+    void advise_sequential() const { ::madvise(data_, size_, MADV_SEQUENTIAL); }
+
+    //! \brief Advise the kernel that the file will be read at random positions
+    void advise_random() const { ::madvise(data_, size_, MADV_RANDOM); }
+};
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_IO_MAPPED_FILE_H_
@@ -0,0 +1,151 @@
+#ifndef INCLUDE_IO_SERIALIZATION_H_
+#define INCLUDE_IO_SERIALIZATION_H_
+
+#include <exception/invalid_format.h>
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace pdstl {
+
+/*! \brief Header of serialized structures
+ *
+ * Serialized structures start with this 128-byte header followed by the payload, the memory
+ * of their tables as laid out in a running process, so a file can be memory mapped and used
+ * in place. Integers are written in the byte order of the host, which is recorded and checked
+ * on load. Structures fill \a geometry with the parameters which must match on load, e.g.
+ * template arguments, and \a shape with the ones restored on load, e.g. the number of buckets.
+ *
+ * Version 1 is the first version of the format.
+ */
+struct serialized_header {
+    static constexpr uint32_t k_version = 1;
+    static constexpr uint32_t k_byte_order = 0x01020304;
+    static constexpr std::size_t k_name_size = 16;
+    static constexpr std::size_t k_geometry_size = 3;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    char structure[k_name_size];
+    char hash_family[k_name_size];
+    uint32_t hash_bits;
+    uint32_t reserved;
+    uint64_t seeds[2];
+    uint64_t geometry[k_geometry_size];
+    uint64_t shape[k_geometry_size];
+    uint64_t count;
+
+    //! Empty header, to read a saved one into
+    serialized_header() : serialized_header(std::string(), std::string(), 0) {}
+
+    /*! \brief Header of the current version for a structure
+     *
+     * \param structure_name - name of the structure, at most 15 characters
+     * \param family - name of the hash family, see hash_factory::family
+     * \param bits - number of bits of hash outputs
+     */
+    serialized_header(const std::string& structure_name, const std::string& family, uint32_t bits)
+        : magic{'p', 'd', 's', 't', 'l', 0, 0, 0},
+          version(k_version),
+          byte_order(k_byte_order),
+          structure{},
+          hash_family{},
+          hash_bits(bits),
+          reserved(0),
+          seeds{},
+          geometry{},
+          shape{},
+          count(0) {
+        structure_name.copy(structure, k_name_size - 1);
+        family.copy(hash_family, k_name_size - 1);
+    }
+
+    /*! \brief Throws invalid_format_exception unless \a saved is a valid header of the same
+     * structure, hash family, hash size and geometry as this header
+     */
+    void check(const serialized_header& saved) const {
+        if (std::memcmp(saved.magic, magic, sizeof(magic)) != 0) {
+            throw invalid_format_exception("not a pdstl structure");
+        }
+        if (saved.version != version) {
+            throw invalid_format_exception("unsupported version " + std::to_string(saved.version));
+        }
+        if (saved.byte_order != byte_order) {
+            throw invalid_format_exception("saved with another byte order");
+        }
+        if (std::strncmp(saved.structure, structure, k_name_size) != 0) {
+            throw invalid_format_exception("saved structure is " + std::string(saved.structure, std::find(saved.structure, saved.structure + k_name_size - 1, 0)));
+        }
+        if (std::strncmp(saved.hash_family, hash_family, k_name_size) != 0 || saved.hash_bits != hash_bits || hash_family[0] == 0) {
+            throw invalid_format_exception("hash functions do not match");
+        }
+        if (std::memcmp(saved.geometry, geometry, sizeof(geometry)) != 0) {
+            throw invalid_format_exception("geometry does not match");
+        }
+    }
+};
+
+static_assert(sizeof(serialized_header) == 128, "Serialized header must take 128 bytes");
+
+//! \brief Writes \a size bytes at \a data to \a out
+inline void write_bytes(std::ostream& out, const void* data, std::size_t size) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+//! \brief Reads \a size bytes from \a in into \a data, throws invalid_format_exception if the input is truncated
+inline void read_bytes(std::istream& in, void* data, std::size_t size) {
+    if (!in.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+        throw invalid_format_exception("truncated input");
+    }
+}
+
+//! \brief Reads a header from \a in, throws invalid_format_exception if the input is truncated
+inline serialized_header read_header(std::istream& in) {
+    serialized_header header;
+    read_bytes(in, &header, sizeof(header));
+    return header;
+}
+
+//! \brief Reads a header from the first bytes of \a size bytes at \a data, e.g. a mapped file
+inline serialized_header read_header(const void* data, std::size_t size) {
+    if (size < sizeof(serialized_header)) {
+        throw invalid_format_exception("truncated input");
+    }
+    serialized_header header;
+    std::memcpy(&header, data, sizeof(header));
+    return header;
+}
+
+/*! \brief Writes the bits of \a bits to \a out, packed into 64-bit words
+ *
+ * Bit i is written as bit i % 64 of word i / 64.
+ */
+template <std::size_t N>
+void write_bitset(std::ostream& out, const std::bitset<N>& bits) {
+    std::vector<uint64_t> words((N + 63) / 64, 0);
+    for (std::size_t bit = 0; bit < N; ++bit) {
+        words[bit / 64] |= uint64_t(bits[bit]) << (bit % 64);
+    }
+    write_bytes(out, words.data(), words.size() * sizeof(uint64_t));
+}
+
+//! \brief Reads bits written by write_bitset from \a in into \a bits, throws invalid_format_exception if the input is truncated
+template <std::size_t N>
+void read_bitset(std::istream& in, std::bitset<N>& bits) {
+    std::vector<uint64_t> words((N + 63) / 64);
+    read_bytes(in, words.data(), words.size() * sizeof(uint64_t));
+    for (std::size_t bit = 0; bit < N; ++bit) {
+        bits[bit] = (words[bit / 64] >> (bit % 64)) & 1;
+    }
+}
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_IO_SERIALIZATION_H_
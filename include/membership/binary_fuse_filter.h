@@ -0,0 +1,314 @@
+#ifndef INCLUDE_MEMBERSHIP_BINARY_FUSE_FILTER_H_
+#define INCLUDE_MEMBERSHIP_BINARY_FUSE_FILTER_H_
+
+#include <exception/not_supported.h>
+#include <hash/mmh3_hash_factory.h>
+#include <utils/bits.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "membership.h"
+
+namespace pdstl {
+
+/*! \brief Binary Fuse Filter
+ *
+ * binary_fuse_filter class implements 3-wise binary fuse filter (Graf and Lemire, "Binary Fuse
+ * Filters: Fast and Smaller Than Xor Filters") for solving membership problem on static sets.
+ *
+ * The filter is an array of FB-bit fingerprints split into segments. Each item maps to one slot
+ * in each of three consecutive segments, and the fingerprints are assigned so that the xor of
+ * the three slots of every item is the fingerprint of the item. A lookup reads exactly these
+ * three slots. The array takes about 1.13 * FB bits per item for large sets, against 1.44 * FB
+ * bits for a bloom filter with the same false positive rate of 2^-FB.
+ *
+ * The filter is built once from a range of items by peeling: slots used by a single item are
+ * assigned last, removing their item frees the other slots of the item, and so on. Items are
+ * ordered by segment before peeling, so the counters of neighbouring items share cache lines.
+ * Items can not be inserted or erased afterwards, insert and erase throw
+ * not_supported_exception.
+ *
+ * \tparam FB - Number of bits of each fingerprint, 8, 16 or 32 (default: 8)
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into binary fuse filter (default: std::string)
+ */
+template <
+    std::size_t FB = 8,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string>
+class binary_fuse_filter : public membership<T> {
+   public:
+    typedef typename std::conditional<
+        FB == 8,
+        uint8_t,
+        typename std::conditional<FB == 16, uint16_t, uint32_t>::type>::type finger_print_type;
+
+   protected:
+    static constexpr std::size_t k_max_segment_length = std::size_t(1) << 18;
+    static constexpr std::size_t k_max_attempts = 100;
+
+    std::unique_ptr<HF<T, uint64_t>> hash_factory_;
+    std::unique_ptr<hash<T, uint64_t>> hash_;
+    uint64_t seed_;
+    std::size_t segment_length_;
+    std::size_t segment_count_length_;
+    std::size_t num_items_;
+    std::vector<finger_print_type> finger_prints_;
+
+    //! Hash of an item hash for the current construction attempt (murmur3 finalizer)
+    inline uint64_t mix(uint64_t hash_value) const {
+        uint64_t h = hash_value + seed_;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    inline finger_print_type make_finger_print(uint64_t h) const { return static_cast<finger_print_type>(h ^ (h >> 32)); }
+
+    //! Slots of \a h in three consecutive segments
+    inline void positions(uint64_t h, std::size_t (&slots)[3]) const {
+        slots[0] = static_cast<std::size_t>(multiply_high(h, segment_count_length_));
+        slots[1] = (slots[0] + segment_length_) ^ ((h >> 18) & (segment_length_ - 1));
+        slots[2] = (slots[0] + 2 * segment_length_) ^ (h & (segment_length_ - 1));
+    }
+
+    //! Sets the segment geometry for \a num_items items and zeroes the fingerprints
+    void allocate(std::size_t num_items);
+
+    //! Assigns the fingerprints of items with hashes \a hashes, removing duplicate hashes
+    void build(std::vector<uint64_t>& hashes);
+
+    //! Peels the items of \a hashes with the current seed, returns false if some items can not be peeled
+    bool peel(const std::vector<uint64_t>& hashes, std::vector<uint64_t>& order, std::vector<uint8_t>& order_slots, std::size_t& num_peeled);
+
+   public:
+    //! Default constructor, a filter of the empty set
+    binary_fuse_filter();
+
+    /*! \brief Constructs a filter of a range of items
+     *
+     * Items are hashed once, repeated items are stored once.
+     * Throws std::runtime_error if the items can not be peeled, which should never happen.
+     *
+     * \param first - iterator to the first item.
+     * \param last - iterator past the last item.
+     */
+    template <typename I>
+    binary_fuse_filter(I first, I last);
+
+    /*! \brief Insert is not supported in binary fuse filter. will throw an exception
+     *
+     * \param item - the item to insert into the filter.
+     */
+    void insert(const T& item) override;
+
+    /*! \brief Erase is not supported in binary fuse filter. will throw an exception
+     *
+     * \param item - the item to erase from filter.
+     */
+    void erase(const T& item) override;
+
+    //! \brief Clear filter, leaving a filter of the empty set.
+    void clear() override;
+
+    /*! \brief Check the item and report that it's in the filter or not.
+     *
+     * \param item - the item to check for existence.
+     *
+     * \return false if the item is not in the filter, true if item may be in the filter.
+     */
+    bool contains(const T& item) const override;
+
+    //! \brief Number of distinct items of the filter.
+    std::size_t size() const { return num_items_; }
+
+    //! \brief Number of fingerprint slots of the filter.
+    std::size_t capacity() const { return finger_prints_.size(); }
+};
+
+template <std::size_t FB, template <typename...> class HF, typename T>
+constexpr std::size_t binary_fuse_filter<FB, HF, T>::k_max_segment_length;
+
+template <std::size_t FB, template <typename...> class HF, typename T>
+constexpr std::size_t binary_fuse_filter<FB, HF, T>::k_max_attempts;
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t FB,                     \
+        template <typename...> class HF,    \
+        typename T>                         \
+    __VA_ARGS__ binary_fuse_filter<FB, HF, T>::method_name
+
+CLASS_METHOD_IMPL(binary_fuse_filter, )
+() : hash_factory_(std::make_unique<HF<T, uint64_t>>()), seed_(0), num_items_(0) {
+    static_assert(FB == 8 || FB == 16 || FB == 32, "Fingerprint bits must be 8, 16 or 32");
+    hash_ = hash_factory_->create_hash();
+    allocate(0);
+}
+
+template <std::size_t FB, template <typename...> class HF, typename T>
+template <typename I>
+binary_fuse_filter<FB, HF, T>::binary_fuse_filter(I first, I last) : binary_fuse_filter() {
+    std::vector<uint64_t> hashes;
+    hashes.reserve(std::distance(first, last));
+    for (; first != last; ++first) {
+        hashes.push_back(hash_->value(*first));
+    }
+    build(hashes);
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& /* item */) {
+    throw not_supported_exception();
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(const T& /* item */) {
+    throw not_supported_exception();
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    allocate(0);
+    num_items_ = 0;
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(const T& item) const {
+    // fingerprints of an empty filter are all zero and would match 2^-FB of the items
+    if (num_items_ == 0) {
+        return false;
+    }
+    uint64_t h = mix(hash_->value(item));
+    std::size_t slots[3];
+    positions(h, slots);
+    return (make_finger_print(h) ^ finger_prints_[slots[0]] ^ finger_prints_[slots[1]] ^ finger_prints_[slots[2]]) == 0;
+}
+
+CLASS_METHOD_IMPL(allocate, void)
+(std::size_t num_items) {
+    // segments of 2^floor(log_3.33(n) + 2.25) slots and 1.125 slots per item for large sets
+    segment_length_ = num_items == 0 ? 4 : std::size_t(1) << static_cast<std::size_t>(std::floor(std::log(num_items) / std::log(3.33) + 2.25));
+    segment_length_ = std::min(segment_length_, k_max_segment_length);
+    double size_factor = num_items <= 1 ? 0 : std::max(1.125, 0.875 + 0.25 * std::log(1000000.0) / std::log(num_items));
+    std::size_t capacity = static_cast<std::size_t>(std::round(num_items * size_factor));
+    std::size_t segment_count = (capacity + segment_length_ - 1) / segment_length_;
+    segment_count = segment_count <= 2 ? 1 : segment_count - 2;
+    segment_count_length_ = segment_count * segment_length_;
+    finger_prints_.assign(segment_count_length_ + 2 * segment_length_, 0);
+}
+
+CLASS_METHOD_IMPL(build, void)
+(std::vector<uint64_t>& hashes) {
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    allocate(hashes.size());
+
+    std::vector<uint64_t> order(hashes.size());
+    std::vector<uint8_t> order_slots(hashes.size());
+    std::size_t num_peeled = 0;
+    std::size_t attempt = 0;
+    for (seed_ = 0; !peel(hashes, order, order_slots, num_peeled); seed_ += 0x9E3779B97F4A7C15ULL) {
+        if (++attempt == k_max_attempts) {
+            throw std::runtime_error("Binary fuse filter construction failed.");
+        }
+    }
+    // assign fingerprints in reverse peeling order, each slot is set after the other slots of its item
+    for (std::size_t index = num_peeled; index-- > 0;) {
+        uint64_t h = order[index];
+        std::size_t slots[3];
+        positions(h, slots);
+        std::size_t slot = order_slots[index];
+        finger_prints_[slots[slot]] = make_finger_print(h) ^ finger_prints_[slots[(slot + 1) % 3]] ^ finger_prints_[slots[(slot + 2) % 3]];
+    }
+    num_items_ = num_peeled;
+}
+
+CLASS_METHOD_IMPL(peel, bool)
+(const std::vector<uint64_t>& hashes, std::vector<uint64_t>& order, std::vector<uint8_t>& order_slots, std::size_t& num_peeled) {
+    std::size_t capacity = finger_prints_.size();
+    // items sorted by segment, hashes are placed by their high bits, which give their first segment
+    std::size_t block_bits = 1;
+    while ((std::size_t(1) << block_bits) < segment_count_length_ / segment_length_) {
+        ++block_bits;
+    }
+    std::size_t num_blocks = std::size_t(1) << block_bits;
+    std::vector<std::size_t> block_ends(num_blocks + 1, 0);
+    std::vector<uint64_t> sorted(hashes.size());
+    for (uint64_t hash_value : hashes) {
+        ++block_ends[(mix(hash_value) >> (64 - block_bits)) + 1];
+    }
+    std::partial_sum(block_ends.begin(), block_ends.end(), block_ends.begin());
+    for (uint64_t hash_value : hashes) {
+        uint64_t h = mix(hash_value);
+        sorted[block_ends[h >> (64 - block_bits)]++] = h;
+    }
+
+    // per slot: number of items (times 4) with the xor of the index of the slot among the 3 slots of each item, and xor of their hashes
+    std::vector<uint8_t> counts(capacity, 0);
+    std::vector<uint64_t> xors(capacity, 0);
+    for (uint64_t h : sorted) {
+        std::size_t slots[3];
+        positions(h, slots);
+        for (std::size_t slot = 0; slot < 3; ++slot) {
+            if (counts[slots[slot]] >= 0xFC) {
+                return false;
+            }
+            counts[slots[slot]] = static_cast<uint8_t>((counts[slots[slot]] + 4) ^ slot);
+            xors[slots[slot]] ^= h;
+        }
+    }
+
+    std::vector<std::size_t> alone;
+    alone.reserve(capacity);
+    for (std::size_t slot = 0; slot < capacity; ++slot) {
+        if ((counts[slot] >> 2) == 1) {
+            alone.push_back(slot);
+        }
+    }
+    num_peeled = 0;
+    while (!alone.empty()) {
+        std::size_t index = alone.back();
+        alone.pop_back();
+        if ((counts[index] >> 2) != 1) {
+            continue;
+        }
+        uint64_t h = xors[index];
+        std::size_t found = counts[index] & 3;
+        order[num_peeled] = h;
+        order_slots[num_peeled] = static_cast<uint8_t>(found);
+        ++num_peeled;
+        std::size_t slots[3];
+        positions(h, slots);
+        for (std::size_t other = 1; other < 3; ++other) {
+            std::size_t slot = (found + other) % 3;
+            std::size_t other_index = slots[slot];
+            counts[other_index] = static_cast<uint8_t>((counts[other_index] - 4) ^ slot);
+            xors[other_index] ^= h;
+            if ((counts[other_index] >> 2) == 1) {
+                alone.push_back(other_index);
+            }
+        }
+        counts[index] = 0;
+        xors[index] = 0;
+    }
+    return num_peeled == hashes.size();
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_MEMBERSHIP_BINARY_FUSE_FILTER_H_
@@ -0,0 +1,240 @@
+#ifndef INCLUDE_MEMBERSHIP_CASCADE_FILTER_H_
+#define INCLUDE_MEMBERSHIP_CASCADE_FILTER_H_
+
+#include <exception/capacity_exceeded.h>
+#include <exception/not_supported.h>
+#include <hash/mmh3_hash_factory.h>
+#include <io/mapped_file.h>
+#include <table/quotient_table.h>
+#include <utils/bits.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "membership.h"
+
+namespace pdstl {
+
+/*! \brief Cascade Filter
+ *
+ * cascade_filter class implements cascade filter algorithm (Bender et al., "Don't Thrash: How to
+ * Cache your Hash on Flash") for solving membership problem on sets larger than memory.
+ *
+ * Items are inserted into an in-memory quotient table of 2^Q slots. Once it is full, it is merged
+ * with the on-disk levels 0 .. j-1 into the first empty level j, which has 2^(Q + j) slots. Merges
+ * read their sources and write their destination sequentially, in fingerprint order. Each level
+ * is a quotient table laid out in a memory mapped file, so a lookup only touches the pages of
+ * the blocks holding its run on each level.
+ *
+ * Level files are created under unique names in a given directory and unlinked before they are
+ * mapped, see mapped_file::create_temporary, so they are removed when the filter is destroyed
+ * (or the process exits).
+ *
+ * \tparam F - Fingerprint bits, must be smaller than or equal to hash output size
+ * \tparam Q - Number of bits for quotient part of the in-memory table
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into cascade filter (default: std::string)
+ * \tparam S - Hash output type (default: uint32_t)
+ */
+template <
+    std::size_t F,
+    std::size_t Q,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string,
+    typename S = uint32_t>
+class cascade_filter : public membership<T> {
+   protected:
+    typedef quotient_table<S, F - Q, true> table_type;
+
+    typedef struct {
+        std::unique_ptr<mapped_file> file;
+        std::unique_ptr<table_type> table;
+    } level;
+
+    std::unique_ptr<HF<T, S>> hash_factory_;
+    std::unique_ptr<hash<T, S>> hash_;
+    const std::string k_directory_;
+    const float k_max_load_factor_;
+    table_type buffer_;
+    std::vector<level> levels_;
+
+    inline S fingerprint(const T& item) const { return static_cast<S>(hash_->value(item) & bitmask(F)); }
+
+    //! Merges the in-memory table and the leading non-empty levels into the first empty level
+    void flush();
+
+   public:
+    /*! \brief Default constructor
+     *
+     * \param directory - directory of the level files.
+     * \param max_load_factor - fraction of in-memory slots in use that triggers a merge (default: 0.95)
+     */
+    explicit cascade_filter(const std::string& directory, float max_load_factor = 0.95f);
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * \param directory - directory of the level files.
+     * \param max_load_factor - fraction of in-memory slots in use that triggers a merge
+     * \param seed - seed of the hash function
+     */
+    cascade_filter(const std::string& directory, float max_load_factor, S seed);
+
+    /*! \brief insert an item into cascade filter
+     *
+     * Throws capacity_exceeded_exception if a merge needs a level with no remainder bits left.
+     *
+     * \param item - the item to insert into the cascade filter.
+     */
+    void insert(const T& item) override;
+
+    /*! \brief Erase is not supported in cascade filter. will throw an exception
+     *
+     * \param item - the item to erase from filter.
+     */
+    void erase(const T& item) override;
+
+    //! \brief Clear filter and removes its levels.
+    void clear() override;
+
+    /*! \brief Check the item and report that it's in the filter or not.
+     *
+     * \param item - the item to check for existence.
+     *
+     * \return false if the item is not in the filter, true if item may be in the filter.
+     */
+    bool contains(const T& item) const override;
+};
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t F,                      \
+        std::size_t Q,                      \
+        template <typename...> class HF,    \
+        typename T,                         \
+        typename S>                         \
+    __VA_ARGS__ cascade_filter<F, Q, HF, T, S>::method_name
+
+CLASS_METHOD_IMPL(cascade_filter, )
+(const std::string& directory, float max_load_factor) : hash_factory_(std::make_unique<HF<T, S>>()),
+                                                        k_directory_(directory),
+                                                        k_max_load_factor_(max_load_factor),
+                                                        buffer_(std::size_t(1) << Q) {
+    static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
+    static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
+    hash_ = hash_factory_->create_hash();
+}
+
+CLASS_METHOD_IMPL(cascade_filter, )
+(const std::string& directory, float max_load_factor, S seed) : hash_factory_(std::make_unique<HF<T, S>>()),
+                                                                k_directory_(directory),
+                                                                k_max_load_factor_(max_load_factor),
+                                                                buffer_(std::size_t(1) << Q) {
+    static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
+    static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
+    hash_ = hash_factory_->create_hash(seed);
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item) {
+    if (buffer_.size() + 1 > k_max_load_factor_ * buffer_.capacity()) {
+        flush();
+    }
+    S fp = fingerprint(item);
+    buffer_.insert(fp >> (F - Q), fp & bitmask(F - Q));
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(const T& /* item */) {
+    throw not_supported_exception();
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    buffer_.clear();
+    levels_.clear();
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(const T& item) const {
+    S fp = fingerprint(item);
+    if (buffer_.contains(fp >> (F - Q), fp & bitmask(F - Q))) {
+        return true;
+    }
+    for (std::size_t index = 0; index < levels_.size(); ++index) {
+        std::size_t remainder_bits = F - Q - index;
+        if (levels_[index].table && levels_[index].table->contains(fp >> remainder_bits, fp & bitmask(remainder_bits))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(flush, void)
+() {
+    std::size_t target = 0;
+    while (target < levels_.size() && levels_[target].table) {
+        ++target;
+    }
+    if (Q + target + 1 > F) {
+        throw capacity_exceeded_exception();
+    }
+    if (target == levels_.size()) {
+        levels_.emplace_back();
+    }
+
+    typedef struct {
+        typename table_type::const_iterator current;
+        typename table_type::const_iterator end;
+        std::size_t remainder_bits;
+        S fingerprint;
+    } source;
+    std::vector<source> sources;
+    auto add_source = [&sources](const table_type& table, std::size_t remainder_bits) {
+        source src{table.begin(), table.end(), remainder_bits, 0};
+        if (src.current != src.end) {
+            src.fingerprint = static_cast<S>((S((*src.current).first) << remainder_bits) | (*src.current).second);
+            sources.push_back(src);
+        }
+    };
+    add_source(buffer_, F - Q);
+    for (std::size_t index = 0; index < target; ++index) {
+        levels_[index].file->advise_sequential();
+        add_source(*levels_[index].table, F - Q - index);
+    }
+
+    std::size_t size = std::size_t(1) << (Q + target);
+    std::size_t remainder_bits = F - Q - target;
+    level merged;
+    merged.file = mapped_file::create_temporary(k_directory_, table_type::memory_size(size));
+    merged.table = std::make_unique<table_type>(size, merged.file->data());
+    while (!sources.empty()) {
+        auto next = sources.begin();
+        for (auto it = sources.begin() + 1; it != sources.end(); ++it) {
+            if (it->fingerprint < next->fingerprint) {
+                next = it;
+            }
+        }
+        S fp = next->fingerprint;
+        merged.table->push_back(fp >> remainder_bits, fp & bitmask(remainder_bits));
+        if (++next->current == next->end) {
+            sources.erase(next);
+        } else {
+            next->fingerprint = static_cast<S>((S((*next->current).first) << next->remainder_bits) | (*next->current).second);
+        }
+    }
+    merged.file->advise_random();
+
+    for (std::size_t index = 0; index < target; ++index) {
+        levels_[index].table.reset();
+        levels_[index].file.reset();
+    }
+    levels_[target] = std::move(merged);
+    buffer_.clear();
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_MEMBERSHIP_CASCADE_FILTER_H_
@@ -0,0 +1,330 @@
+#ifndef INCLUDE_MEMBERSHIP_CONCURRENT_CUCKOO_FILTER_H_
+#define INCLUDE_MEMBERSHIP_CONCURRENT_CUCKOO_FILTER_H_
+
+#include <exception/capacity_exceeded.h>
+#include <hash/mmh3_hash_factory.h>
+#include <utils/bits.h>
+#include <utils/seq_lock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "cuckoo_filter.h"
+#include "membership.h"
+
+namespace pdstl {
+
+/*! \brief Concurrent Cuckoo Filter
+ *
+ * concurrent_cuckoo_filter class implements a cuckoo filter which several threads can insert
+ * into, erase from and query at the same time (Fan et al., "MemC3: Compact and Concurrent
+ * MemCache with Dumber Caching and Smarter Hashing"; Li et al., "Algorithmic Improvements for
+ * Fast Concurrent Cuckoo Hashing").
+ *
+ * Buckets are kept in atomic words and guarded by stripes of sequence locks. contains takes no
+ * lock: it reads the version of the stripes of both buckets of an item, reads the buckets and
+ * retries if a writer changed either stripe meanwhile, so reads scale with cores under a read
+ * mostly load. insert and erase lock the stripes of the two buckets of an item, lowest first.
+ *
+ * When both buckets are full, insert searches the eviction path breadth first without locks,
+ * then moves the fingerprints one step at a time from the end of the path, locking the two
+ * buckets of each step and checking the step is still valid. A fingerprint is copied to its
+ * new bucket before it is erased from the old one, so it is never missing from the table.
+ * Unlike cuckoo_filter there is no victim stash; inserting into a full filter throws.
+ *
+ * \tparam CT - cuckoo table, its buckets must fit in 64 bits
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into cuckoo filter (default: std::string)
+ * \tparam S - Hash output type (default: uint32_t)
+ */
+template <
+    typename CT,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string,
+    typename S = uint32_t>
+class concurrent_cuckoo_filter : public membership<T> {
+   protected:
+    typedef typename CT::bucket_type bucket_type;
+
+    static constexpr size_t k_max_stripes = 4096;
+    static constexpr size_t k_no_parent = ~size_t(0);
+
+    //! Bucket of the eviction search, reached by moving \a finger_print out of bucket \a parent
+    struct path_node {
+        size_t index;
+        size_t parent;
+        S finger_print;
+    };
+
+    //! Locks the stripes of two buckets in ascending order and unlocks them on destruction
+    class pair_guard {
+       private:
+        seq_lock& first_;
+        seq_lock& second_;
+
+       public:
+        pair_guard(const concurrent_cuckoo_filter& filter, size_t i, size_t j)
+            : first_(filter.stripes_[std::min(filter.stripe(i), filter.stripe(j))]),
+              second_(filter.stripes_[std::max(filter.stripe(i), filter.stripe(j))]) {
+            first_.lock();
+            if (&second_ != &first_) {
+                second_.lock();
+            }
+        }
+        ~pair_guard() {
+            if (&second_ != &first_) {
+                second_.unlock();
+            }
+            first_.unlock();
+        }
+        pair_guard(const pair_guard&) = delete;
+        pair_guard& operator=(const pair_guard&) = delete;
+    };
+
+    std::unique_ptr<HF<T, S>> finger_print_factory_;
+    std::unique_ptr<hash<T, S>> finger_print_;
+    std::unique_ptr<HF<S, S>> hash_factory_;
+    std::unique_ptr<hash<S, S>> hash_;
+    CT info_;
+    size_t num_buckets_;
+    std::unique_ptr<std::atomic<bucket_type>[]> buckets_;
+    size_t num_stripes_;
+    std::unique_ptr<seq_lock[]> stripes_;
+    const size_t k_max_kicks_;
+
+    //! Non-zero fingerprint from the high bits of \a hash_value, 0 marks empty slots
+    inline S make_finger_print(S hash_value) const {
+        S finger_print = static_cast<S>((hash_value >> (sizeof(S) * 8 - info_.finger_print_bits)) & bitmask(info_.finger_print_bits));
+        return finger_print == 0 ? 1 : finger_print;
+    }
+    inline size_t alternate_index(size_t index, S finger_print) const { return index ^ (hash_->value(finger_print) & (num_buckets_ - 1)); }
+    inline size_t stripe(size_t index) const { return index & (num_stripes_ - 1); }
+    inline bucket_type load(size_t index) const { return buckets_[index].load(std::memory_order_acquire); }
+    inline void store(size_t index, const bucket_type& bucket) { buckets_[index].store(bucket, std::memory_order_release); }
+
+    //! Inserts \a finger_print into bucket \a i or \a j if one of them has an empty slot
+    bool insert_locked(size_t i, size_t j, S finger_print);
+
+    //! Searches the shortest eviction path from bucket \a i or \a j without taking locks
+    bool find_path(size_t i, size_t j, std::vector<path_node>& nodes) const;
+
+    //! Moves the fingerprints of the path ending at \a node, returns false if the path went stale
+    bool apply_path(const std::vector<path_node>& nodes, size_t node);
+
+   public:
+    /*! \brief Default constructor
+     *
+     * \param num_buckets - number of buckets in this filter
+     * \param max_kicks - maximum number of buckets visited when searching for an eviction path
+     */
+    concurrent_cuckoo_filter(size_t num_buckets, size_t max_kicks);
+
+    /*! \brief insert an item into concurrent cuckoo filter
+     *
+     * Throws capacity_exceeded_exception if the filter is full.
+     *
+     * \param item - the item to insert into the concurrent cuckoo filter.
+     */
+    void insert(const T& item) override;
+
+    /*! \brief insert an item into concurrent cuckoo filter if there is room for it
+     *
+     * \param item - the item to insert into the concurrent cuckoo filter.
+     *
+     * \return true if the item is inserted, false if no eviction path was found.
+     */
+    bool try_insert(const T& item);
+
+    /*! \brief Erase an item from concurrent cuckoo filter
+     *
+     * Erasing an item which was not inserted may remove another item with the same fingerprint.
+     *
+     * \param item - the item to erase from filter.
+     */
+    void erase(const T& item) override;
+
+    //! \brief Clear filter and resets its internal memory, must not run along other operations.
+    void clear() override;
+
+    /*! \brief Check the item and report that it's in the filter or not.
+     *
+     * \param item - the item to check for existence.
+     *
+     * \return false if the item is not in the filter, true if item may be in the filter.
+     */
+    bool contains(const T& item) const override;
+};
+
+template <typename CT, template <typename...> class HF, typename T, typename S>
+constexpr size_t concurrent_cuckoo_filter<CT, HF, T, S>::k_max_stripes;
+
+template <typename CT, template <typename...> class HF, typename T, typename S>
+constexpr size_t concurrent_cuckoo_filter<CT, HF, T, S>::k_no_parent;
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        typename CT,                        \
+        template <typename...> class HF,    \
+        typename T,                         \
+        typename S>                         \
+    __VA_ARGS__ concurrent_cuckoo_filter<CT, HF, T, S>::method_name
+
+CLASS_METHOD_IMPL(concurrent_cuckoo_filter, )
+(size_t num_buckets, size_t max_kicks) : finger_print_factory_(std::make_unique<HF<T, S>>()),
+                                         hash_factory_(std::make_unique<HF<S, S>>()),
+                                         info_(1),
+                                         num_buckets_(CT::round_up(num_buckets)),
+                                         buckets_(new std::atomic<bucket_type>[num_buckets_]),
+                                         num_stripes_(std::min(num_buckets_, k_max_stripes)),
+                                         stripes_(new seq_lock[num_stripes_]),
+                                         k_max_kicks_(max_kicks) {
+    static_assert(std::is_trivially_copyable<bucket_type>::value && sizeof(bucket_type) <= sizeof(uint64_t),
+                  "Buckets must be trivially copyable and fit in 64 bits");
+    hash_ = hash_factory_->create_hash();
+    finger_print_ = finger_print_factory_->create_hash();
+    clear();
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item) {
+    if (!try_insert(item)) {
+        throw capacity_exceeded_exception();
+    }
+}
+
+CLASS_METHOD_IMPL(try_insert, bool)
+(const T& item) {
+    S hash_value = finger_print_->value(item);
+    S finger_print = make_finger_print(hash_value);
+    size_t i = hash_value & (num_buckets_ - 1);
+    size_t j = alternate_index(i, finger_print);
+    std::vector<path_node> nodes;
+    while (!insert_locked(i, j, finger_print)) {
+        // other threads may fill the freed slot or move fingerprints of the path, search again
+        if (!find_path(i, j, nodes)) {
+            return false;
+        }
+        apply_path(nodes, nodes.size() - 1);
+    }
+    return true;
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(const T& item) {
+    S hash_value = finger_print_->value(item);
+    S finger_print = make_finger_print(hash_value);
+    size_t i = hash_value & (num_buckets_ - 1);
+    size_t j = alternate_index(i, finger_print);
+    pair_guard guard(*this, i, j);
+    for (size_t index : {i, j}) {
+        bucket_type bucket = load(index);
+        if (bucket.contains(finger_print)) {
+            bucket.erase(finger_print);
+            store(index, bucket);
+            return;
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    for (size_t index = 0; index < num_buckets_; ++index) {
+        store(index, bucket_type());
+    }
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(const T& item) const {
+    S hash_value = finger_print_->value(item);
+    S finger_print = make_finger_print(hash_value);
+    size_t i = hash_value & (num_buckets_ - 1);
+    size_t j = alternate_index(i, finger_print);
+    const seq_lock& first = stripes_[stripe(i)];
+    const seq_lock& second = stripes_[stripe(j)];
+    while (true) {
+        uint32_t first_version = first.read_begin();
+        uint32_t second_version = second.read_begin();
+        if (load(i).contains(finger_print) || load(j).contains(finger_print)) {
+            return true;
+        }
+        // a miss is only trusted if no fingerprint moved between the two buckets meanwhile
+        if (!first.read_retry(first_version) && !second.read_retry(second_version)) {
+            return false;
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(insert_locked, bool)
+(size_t i, size_t j, S finger_print) {
+    pair_guard guard(*this, i, j);
+    for (size_t index : {i, j}) {
+        bucket_type bucket = load(index);
+        if (bucket.insert(finger_print) == 0) {
+            store(index, bucket);
+            return true;
+        }
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(find_path, bool)
+(size_t i, size_t j, std::vector<path_node>& nodes) const {
+    nodes.clear();
+    nodes.push_back({i, k_no_parent, 0});
+    nodes.push_back({j, k_no_parent, 0});
+    for (size_t node = 0; node < nodes.size() && nodes.size() < k_max_kicks_ + 2; ++node) {
+        bucket_type bucket = load(nodes[node].index);
+        for (size_t slot = 0; slot < info_.items_in_bucket && nodes.size() < k_max_kicks_ + 2; ++slot) {
+            S moved = bucket.get(slot);
+            if (moved == 0) {
+                // a slot was freed since the bucket was found full
+                nodes.resize(node + 1);
+                return true;
+            }
+            size_t index = alternate_index(nodes[node].index, moved);
+            bool on_path = false;
+            for (size_t ancestor = node; ancestor != k_no_parent; ancestor = nodes[ancestor].parent) {
+                on_path = on_path || nodes[ancestor].index == index;
+            }
+            if (on_path) {
+                continue;
+            }
+            nodes.push_back({index, node, moved});
+            if (load(index).contains(0)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(apply_path, bool)
+(const std::vector<path_node>& nodes, size_t node) {
+    for (; nodes[node].parent != k_no_parent; node = nodes[node].parent) {
+        size_t from = nodes[nodes[node].parent].index;
+        size_t to = nodes[node].index;
+        S finger_print = nodes[node].finger_print;
+        pair_guard guard(*this, from, to);
+        bucket_type source = load(from);
+        bucket_type target = load(to);
+        if (!source.contains(finger_print) || target.insert(finger_print) != 0) {
+            return false;
+        }
+        source.erase(finger_print);
+        store(to, target);
+        store(from, source);
+    }
+    return true;
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_MEMBERSHIP_CONCURRENT_CUCKOO_FILTER_H_
@@ -0,0 +1,209 @@
+#ifndef INCLUDE_MEMBERSHIP_CONCURRENT_QUOTIENT_FILTER_H_
+#define INCLUDE_MEMBERSHIP_CONCURRENT_QUOTIENT_FILTER_H_
+
+#include <hash/mmh3_hash_factory.h>
+#include <table/concurrent_quotient_table.h>
+#include <utils/bits.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "membership.h"
+
+namespace pdstl {
+
+/*! \brief Concurrent Quotient Filter
+ *
+ * concurrent_quotient_filter class implements a quotient filter which several threads can
+ * insert into, erase from and query at the same time. The table is split into regions guarded
+ * by spin locks, see concurrent_quotient_table.
+ *
+ * Unlike quotient_filter, the filter has a fixed number of 2^Q slots, since expanding would stop
+ * every thread. Inserting into a full filter throws capacity_exceeded_exception.
+ *
+ * Threads inserting many items can go through an insert_buffer, which collects fingerprints and
+ * inserts them in sorted batches, taking each lock once per batch instead of once per item.
+ *
+ * \tparam F - Fingerprint bits, must be smaller than or equal to hash output size
+ * \tparam Q - Number of bits for quotient part, remainder bit size is (F - Q)
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into concurrent quotient filter (default: std::string)
+ * \tparam S - Hash output type (default: uint32_t)
+ * \tparam P - Pack remainders into (F - Q)-bit fields of the table (default: false)
+ */
+template <
+    std::size_t F,
+    std::size_t Q,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string,
+    typename S = uint32_t,
+    bool P = false>
+class concurrent_quotient_filter : public membership<T> {
+   protected:
+    std::unique_ptr<HF<T, S>> hash_factory_;
+    std::unique_ptr<hash<T, S>> hash_;
+    //! Remainders of repeated fingerprints are kept once per insert, so erase removes one of them
+    concurrent_quotient_table<S, F - Q, P, true> table_;
+
+    inline S fingerprint(const T& item) const { return static_cast<S>(hash_->value(item) & bitmask(F)); }
+    inline std::size_t quotient(S fingerprint) const { return fingerprint >> (F - Q); }
+    inline S remainder(S fingerprint) const { return fingerprint & bitmask(F - Q); }
+
+   public:
+    /*! \brief Per-thread insert buffer
+     *
+     * Collects fingerprints of inserted items and inserts them into the filter in sorted
+     * batches when the buffer is full, on flush and on destruction. Items are visible to
+     * contains only after their batch is flushed. A buffer must be used by one thread only.
+     */
+    class insert_buffer {
+       private:
+        concurrent_quotient_filter& filter_;
+        std::vector<std::pair<std::size_t, S>> buffer_;
+        std::size_t capacity_;
+
+       public:
+        /*! \brief Default constructor
+         *
+         * \param filter - the filter to insert into.
+         * \param capacity - number of items in a batch (default: 4096)
+         */
+        explicit insert_buffer(concurrent_quotient_filter& filter, std::size_t capacity = 4096) : filter_(filter), capacity_(capacity) {
+            buffer_.reserve(capacity_);
+        }
+
+        insert_buffer(const insert_buffer&) = delete;
+        insert_buffer& operator=(const insert_buffer&) = delete;
+
+        /*! \brief Flushes remaining items.
+         *
+         * Errors are swallowed here, call flush before destruction to get capacity_exceeded_exception.
+         */
+        ~insert_buffer() {
+            try {
+                flush();
+            } catch (...) {
+            }
+        }
+
+        /*! \brief insert an item, flushing the buffer if it is full
+         *
+         * \param item - the item to insert into the filter.
+         */
+        void insert(const T& item) {
+            S fp = filter_.fingerprint(item);
+            buffer_.emplace_back(filter_.quotient(fp), filter_.remainder(fp));
+            if (buffer_.size() >= capacity_) {
+                flush();
+            }
+        }
+
+        /*! \brief insert buffered items into the filter
+         *
+         * Throws capacity_exceeded_exception if the filter is full, the items which did not fit
+         * are dropped.
+         */
+        void flush() {
+            std::sort(buffer_.begin(), buffer_.end());
+            std::vector<std::pair<std::size_t, S>> batch;
+            batch.swap(buffer_);
+            buffer_.reserve(capacity_);
+            filter_.table_.insert(batch.cbegin(), batch.cend());
+        }
+    };
+
+    //! Default constructor
+    concurrent_quotient_filter();
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * \param seed - seed of the hash function
+     */
+    explicit concurrent_quotient_filter(S seed);
+
+    /*! \brief insert an item into concurrent quotient filter
+     *
+     * Throws capacity_exceeded_exception if the filter is full.
+     *
+     * \param item - the item to insert into the concurrent quotient filter.
+     */
+    void insert(const T& item) override;
+
+    /*! \brief Erase an item from concurrent quotient filter
+     *
+     * Erases one insert of the item. Items sharing its fingerprint stay in the filter, but
+     * erasing an item which was not inserted may remove another item with the same fingerprint.
+     *
+     * \param item - the item to erase from filter.
+     */
+    void erase(const T& item) override;
+
+    //! \brief Clear filter and resets its internal memory, must not run along other operations.
+    void clear() override;
+
+    /*! \biref Check the item and report that it's in the filter or not.
+     *
+     * \param item - the item to check for existence.
+     *
+     * \return false if the item is not in the filter, true if item may be in the filter.
+     */
+    bool contains(const T& item) const override;
+};
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t F,                      \
+        std::size_t Q,                      \
+        template <typename...> class HF,    \
+        typename T,                         \
+        typename S,                         \
+        bool P>                             \
+    __VA_ARGS__ concurrent_quotient_filter<F, Q, HF, T, S, P>::method_name
+
+CLASS_METHOD_IMPL(concurrent_quotient_filter, )
+() : table_(std::size_t(1) << Q) {
+    static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
+    static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
+    hash_factory_ = std::make_unique<HF<T, S>>();
+    hash_ = hash_factory_->create_hash();
+}
+
+CLASS_METHOD_IMPL(concurrent_quotient_filter, )
+(S seed) : table_(std::size_t(1) << Q) {
+    static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
+    static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
+    hash_factory_ = std::make_unique<HF<T, S>>();
+    hash_ = hash_factory_->create_hash(seed);
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item) {
+    S fp = fingerprint(item);
+    table_.insert(quotient(fp), remainder(fp));
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(const T& item) {
+    S fp = fingerprint(item);
+    table_.erase(quotient(fp), remainder(fp));
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    table_.clear();
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(const T& item) const {
+    S fp = fingerprint(item);
+    return table_.contains(quotient(fp), remainder(fp));
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_MEMBERSHIP_CONCURRENT_QUOTIENT_FILTER_H_
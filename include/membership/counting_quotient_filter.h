@@ -0,0 +1,178 @@
+#ifndef INCLUDE_MEMBERSHIP_COUNTING_QUOTIENT_FILTER_H_
+#define INCLUDE_MEMBERSHIP_COUNTING_QUOTIENT_FILTER_H_
+
+#include <hash/mmh3_hash_factory.h>
+#include <table/counting_quotient_table.h>
+#include <utils/bits.h>
+
+#include <memory>
+#include <string>
+
+#include "membership.h"
+
+namespace pdstl {
+
+/*! \brief Counting Quotient Filter
+ *
+ * counting_quotient_filter class implements counting quotient filter algorithm for solving
+ * membership and counting problems.
+ *
+ * Each fingerprint keeps the number of times it is inserted, encoded inline in its run. An item
+ * seen once uses one slot and frequent items use a few more slots, so skewed streams take much
+ * less memory than in a counting bloom filter. Like quotient_filter, the filter starts with 2^Q
+ * slots and expands by taking one remainder bit into the quotient.
+ *
+ * \tparam F - Fingerprint bits, must be smaller than or equal to hash output size
+ * \tparam Q - Initial number of bits for quotient part, remainder bit size is (F - Q)
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into counting quotient filter (default: std::string)
+ * \tparam S - Hash output type (default: uint32_t)
+ * \tparam P - Pack remainders into (F - Q)-bit fields of the table (default: false)
+ */
+template <
+    std::size_t F,
+    std::size_t Q,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string,
+    typename S = uint32_t,
+    bool P = false>
+class counting_quotient_filter : public membership<T> {
+   protected:
+    std::unique_ptr<HF<T, S>> hash_factory_;
+    std::unique_ptr<hash<T, S>> hash_;
+    counting_quotient_table<S, F - Q, P> table_;
+    std::size_t quotient_bits_;
+    const float k_max_load_factor_;
+
+    inline S fingerprint(const T& item) const { return static_cast<S>(hash_->value(item) & bitmask(F)); }
+    inline std::size_t quotient(S fingerprint) const { return fingerprint >> (F - quotient_bits_); }
+    inline S remainder(S fingerprint) const { return fingerprint & bitmask(F - quotient_bits_); }
+
+    //! Rebuilds the table with one more quotient bit
+    void expand();
+
+   public:
+    /*! \brief Default constructor
+     *
+     * \param max_load_factor - fraction of slots in use that triggers expansion (default: 0.95)
+     */
+    explicit counting_quotient_filter(float max_load_factor = 0.95f);
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * \param max_load_factor - fraction of slots in use that triggers expansion
+     * \param seed - seed of the hash function
+     */
+    counting_quotient_filter(float max_load_factor, S seed);
+
+    /*! \brief insert an item into counting quotient filter
+     *
+     * Throws capacity_exceeded_exception if the filter is full and can not expand.
+     *
+     * \param item - the item to insert into the counting quotient filter.
+     */
+    void insert(const T& item) override;
+
+    /*! \brief Erase an item from counting quotient filter, decrementing its count
+     *
+     * Erasing an item which was not inserted may decrement another item with the same fingerprint.
+     *
+     * \param item - the item to erase from filter.
+     */
+    void erase(const T& item) override;
+
+    //! \brief Clear filter and resets its internal memory.
+    void clear() override;
+
+    /*! \biref Check the item and report that it's in the filter or not.
+     *
+     * \param item - the item to check for existence.
+     *
+     * \return false if the item is not in the filter, true if item may be in the filter.
+     */
+    bool contains(const T& item) const override;
+
+    /*! \brief Number of times an item is inserted and not erased.
+     *
+     * \param item - the item to count.
+     *
+     * \return count of the item, which may be larger than the actual count on fingerprint collisions.
+     */
+    uint64_t count(const T& item) const;
+};
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t F,                      \
+        std::size_t Q,                      \
+        template <typename...> class HF,    \
+        typename T,                         \
+        typename S,                         \
+        bool P>                             \
+    __VA_ARGS__ counting_quotient_filter<F, Q, HF, T, S, P>::method_name
+
+CLASS_METHOD_IMPL(counting_quotient_filter, )
+(float max_load_factor) : table_(std::size_t(1) << Q), quotient_bits_(Q), k_max_load_factor_(max_load_factor) {
+    static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
+    static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
+    hash_factory_ = std::make_unique<HF<T, S>>();
+    hash_ = hash_factory_->create_hash();
+}
+
+CLASS_METHOD_IMPL(counting_quotient_filter, )
+(float max_load_factor, S seed) : table_(std::size_t(1) << Q), quotient_bits_(Q), k_max_load_factor_(max_load_factor) {
+    static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
+    static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
+    hash_factory_ = std::make_unique<HF<T, S>>();
+    hash_ = hash_factory_->create_hash(seed);
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item) {
+    if (table_.size() + 1 > k_max_load_factor_ * table_.capacity() && quotient_bits_ + 1 < F) {
+        expand();
+    }
+    S fp = fingerprint(item);
+    table_.insert(quotient(fp), remainder(fp));
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(const T& item) {
+    S fp = fingerprint(item);
+    table_.erase(quotient(fp), remainder(fp));
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    table_ = counting_quotient_table<S, F - Q, P>(std::size_t(1) << Q);
+    quotient_bits_ = Q;
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(const T& item) const {
+    S fp = fingerprint(item);
+    return table_.contains(quotient(fp), remainder(fp));
+}
+
+CLASS_METHOD_IMPL(count, uint64_t)
+(const T& item) const {
+    S fp = fingerprint(item);
+    return table_.count(quotient(fp), remainder(fp));
+}
+
+CLASS_METHOD_IMPL(expand, void)
+() {
+    std::size_t remainder_bits = F - quotient_bits_ - 1;
+    counting_quotient_table<S, F - Q, P> expanded(table_.capacity() * 2);
+    table_.for_each([&expanded, remainder_bits](std::size_t key, S value, uint64_t count) {
+        expanded.insert((key << 1) | (value >> remainder_bits), value & bitmask(remainder_bits), count);
+    });
+    table_ = std::move(expanded);
+    ++quotient_bits_;
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_MEMBERSHIP_COUNTING_QUOTIENT_FILTER_H_
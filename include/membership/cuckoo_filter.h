@@ -1,12 +1,23 @@
 #ifndef INCLUDE_MEMBERSHIP_CUCKOO_FILTER_H_
 #define INCLUDE_MEMBERSHIP_CUCKOO_FILTER_H_
 
+#include <exception/capacity_exceeded.h>
+#include <exception/invalid_format.h>
 #include <exception/not_supported.h>
 #include <hash/mmh3_hash_factory.h>
+#include <io/mapped_file.h>
+#include <io/serialization.h>
+#include <utils/bits.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
 #include <memory>
+#include <ostream>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "membership.h"
@@ -19,79 +30,332 @@ struct bucket_info {
     size_t items_in_bucket = IC;
 };
 
+/*! \brief Array Bucket
+ *
+ * array_bucket class keeps IC fingerprints of FB bits packed into 32-bit words, or 64-bit words
+ * when they do not fit in 32 bits, e.g. four 8-bit fingerprints take one 32-bit word and four
+ * 12 or 16-bit fingerprints take one 64-bit word. A zero fingerprint marks an empty slot.
+ *
+ * contains compares an item against all slots of a word at once, by checking the word xor the
+ * item repeated in every slot for a zero slot (SWAR).
+ *
+ * \tparam FB - Number of bits of each fingerprint (at most 32)
+ * \tparam IC - Number of fingerprints in the bucket
+ */
 template <size_t FB, size_t IC>
-class array_bucket {};
+class array_bucket {
+   public:
+    typedef typename std::conditional<
+        FB <= 8,
+        uint8_t,
+        typename std::conditional<FB <= 16, uint16_t, uint32_t>::type>::type value_type;
+
+    static constexpr size_t k_slots = IC;
+    //! Identifier of the bucket layout in serialized tables
+    static constexpr uint32_t k_layout = 0;
 
-template <size_t IC>
-class array_bucket<4, IC> {
    private:
-    const size_t k_array_size;
-    uint8_t data[IC / 2 + 1];
+    typedef typename std::conditional<FB * IC <= 32, uint32_t, uint64_t>::type word_type;
+
+    static constexpr size_t k_slots_per_word = sizeof(word_type) * 8 / FB;
+    static constexpr size_t k_words = (IC + k_slots_per_word - 1) / k_slots_per_word;
+    static constexpr word_type k_slot_mask = static_cast<word_type>(bitmask(FB));
+
+    word_type words_[k_words];
+
+    //! Word with \a bit set in each of its first \a num_slots slots
+    static word_type slot_bits(size_t num_slots, size_t bit) {
+        word_type bits = 0;
+        for (size_t slot = 0; slot < num_slots; ++slot) {
+            bits |= word_type(1) << (slot * FB + bit);
+        }
+        return bits;
+    }
 
    public:
-    array_bucket() : k_array_size(IC / 2 + 1) {
-        std::fill(data, data + k_array_size, 0);
+    array_bucket() : words_{} {
+        static_assert(FB > 0 && FB <= 32, "Fingerprint bits must be in [1, 32]");
     }
 
-    uint8_t insert(uint8_t item, bool kick = false) {
-        uint8_t m_item = item & 0xF;
-        for (int index = 0; index < k_array_size; ++index) {
-            if ((data[index] & 0x0F) == 0) {
-                data[index] |= m_item;
-                return 0;
-            } else if ((data[index] & 0xF0) == 0) {
-                data[index] |= m_item << 4;
+    //! Fingerprint in \a slot, 0 if the slot is empty
+    value_type get(size_t slot) const {
+        return static_cast<value_type>((words_[slot / k_slots_per_word] >> (slot % k_slots_per_word * FB)) & k_slot_mask);
+    }
+
+    //! Stores \a item in \a slot, 0 empties the slot
+    void set(size_t slot, value_type item) {
+        size_t shift = slot % k_slots_per_word * FB;
+        word_type& word = words_[slot / k_slots_per_word];
+        word = (word & ~(k_slot_mask << shift)) | ((word_type(item) & k_slot_mask) << shift);
+    }
+
+    /*! \brief Insert an item into an empty slot
+     *
+     * \param item - non-zero fingerprint to insert.
+     * \param kick - replace the fingerprint of a slot picked by \a item if the bucket is full.
+     *
+     * \return 0 if the item is inserted into an empty slot, the replaced fingerprint if the
+     * bucket is full and \a kick is set, \a item otherwise.
+     */
+    value_type insert(value_type item, bool kick = false) {
+        for (size_t slot = 0; slot < IC; ++slot) {
+            if (get(slot) == 0) {
+                set(slot, item);
                 return 0;
             }
         }
         if (!kick) {
             return item;
         }
-        uint8_t kickout_item = data[0] & 0x0F;
-        data[0] = (data[0] & 0xF0) | m_item;
+        // victims picked by a multiplicative hash of the item, so chains of kicks do not cycle
+        size_t victim = ((uint64_t(item) * 0x9E3779B97F4A7C15ULL) >> 32) % IC;
+        value_type kickout_item = get(victim);
+        set(victim, item);
         return kickout_item;
     }
 
-    void erase(uint8_t item) {
-        item = item & 0xF;
-        for (int index = 0; index < k_array_size; ++index) {
-            if ((data[index] & 0xF0) == item) {
-                data[index] &= 0x0F;
-            }
-            if ((data[index] & 0x0F) == item) {
-                data[index] &= 0xF0;
+    //! Empties one slot holding \a item, if any
+    void erase(value_type item) {
+        for (size_t slot = 0; slot < IC; ++slot) {
+            if (get(slot) == item) {
+                set(slot, 0);
+                return;
             }
         }
     }
 
-    bool contains(uint8_t item) const {
-        item = item & 0xF;
-        for (int index = 0; index < k_array_size; ++index) {
-            if ((data[index] & 0xF0) == item || (data[index] & 0x0F) == item) {
-                return true;
+    //! First slot holding \a item, IC if there is none
+    size_t find(value_type item) const {
+        for (size_t word = 0; word < k_words; ++word) {
+            size_t num_slots = std::min(k_slots_per_word, IC - word * k_slots_per_word);
+            word_type low_bits = slot_bits(num_slots, 0);
+            word_type high_bits = slot_bits(num_slots, FB - 1);
+            word_type diff = words_[word] ^ (low_bits * item);
+            // borrows may flag slots above a match, never below, so the lowest flag is exact
+            word_type matches = (diff - low_bits) & ~diff & high_bits;
+            if (matches) {
+                return word * k_slots_per_word + count_trailing_zeros(matches) / FB;
             }
         }
-        return false;
+        return IC;
     }
-};
 
-template <size_t IC>
-class array_bucket<8, IC> {
+    //! Whether a slot holds \a item
+    bool contains(value_type item) const { return find(item) < IC; }
+
+    //! Empties all slots
+    void clear() { std::fill(words_, words_ + k_words, 0); }
 };
 
-template <size_t IC>
-class array_bucket<16, IC> {
+template <size_t FB, size_t IC>
+constexpr size_t array_bucket<FB, IC>::k_slots;
+
+template <size_t FB, size_t IC>
+constexpr size_t array_bucket<FB, IC>::k_slots_per_word;
+
+template <size_t FB, size_t IC>
+constexpr size_t array_bucket<FB, IC>::k_words;
+
+/*! \brief Semi-sorted bucket codec
+ *
+ * Tables mapping the 3876 non-decreasing sequences of four 4-bit prefixes to 12-bit indexes
+ * and back, shared by all semi_sorted_bucket instances.
+ */
+class semi_sorted_codec {
+   public:
+    static constexpr size_t k_num_codes = 3876;
+
+    //! Four prefixes packed in nibbles, lowest nibble first, of each index
+    uint16_t decode[k_num_codes];
+    //! Index of each packing of four non-decreasing prefixes
+    uint16_t encode[1 << 16];
+
+    static const semi_sorted_codec& instance() {
+        static const semi_sorted_codec codec;
+        return codec;
+    }
+
+   private:
+    semi_sorted_codec() : decode{}, encode{} {
+        uint16_t index = 0;
+        for (uint16_t a = 0; a < 16; ++a) {
+            for (uint16_t b = a; b < 16; ++b) {
+                for (uint16_t c = b; c < 16; ++c) {
+                    for (uint16_t d = c; d < 16; ++d) {
+                        uint16_t packed = static_cast<uint16_t>(a | (b << 4) | (c << 8) | (d << 12));
+                        decode[index] = packed;
+                        encode[packed] = index++;
+                    }
+                }
+            }
+        }
+    }
 };
 
-template <size_t IC>
-class array_bucket<32, IC> {
+/*! \brief Semi-Sorted Bucket
+ *
+ * semi_sorted_bucket class keeps 4 fingerprints sorted in the bucket (Fan et al., "Cuckoo
+ * Filter: Practically Better Than Bloom"). The highest 4 bits of the sorted fingerprints form
+ * one of only 3876 non-decreasing sequences, stored as a 12-bit index instead of 16 bits, so
+ * each fingerprint costs FB - 1 bits. The remaining FB - 4 bits of each fingerprint are stored
+ * as is. A zero fingerprint marks an empty slot.
+ *
+ * Each access decodes the bucket with a table lookup, and each update sorts and encodes it
+ * again, so slots are renumbered by set, insert and erase.
+ *
+ * \tparam FB - Number of bits of each fingerprint (in [4, 17])
+ * \tparam IC - Number of fingerprints in the bucket, must be 4
+ */
+template <size_t FB, size_t IC = 4>
+class semi_sorted_bucket {
+   public:
+    typedef typename std::conditional<
+        FB <= 8,
+        uint8_t,
+        typename std::conditional<FB <= 16, uint16_t, uint32_t>::type>::type value_type;
+
+    static constexpr size_t k_slots = IC;
+    //! Identifier of the bucket layout in serialized tables
+    static constexpr uint32_t k_layout = 1;
+
+   private:
+    static constexpr size_t k_index_bits = 12;
+    static constexpr size_t k_suffix_bits = FB - 4;
+    static constexpr size_t k_bits = k_index_bits + IC * k_suffix_bits;
+
+    typedef typename std::conditional<
+        k_bits <= 16,
+        uint16_t,
+        typename std::conditional<k_bits <= 32, uint32_t, uint64_t>::type>::type word_type;
+
+    word_type word_;
+
+    void decode(value_type (&items)[IC]) const {
+        uint16_t prefixes = semi_sorted_codec::instance().decode[word_ & bitmask(k_index_bits)];
+        for (size_t slot = 0; slot < IC; ++slot) {
+            uint64_t suffix = (word_ >> (k_index_bits + slot * k_suffix_bits)) & bitmask(k_suffix_bits);
+            items[slot] = static_cast<value_type>((uint64_t((prefixes >> (slot * 4)) & 0xF) << k_suffix_bits) | suffix);
+        }
+    }
+
+    void encode(value_type (&items)[IC]) {
+        std::sort(items, items + IC);
+        uint16_t prefixes = 0;
+        uint64_t word = 0;
+        for (size_t slot = 0; slot < IC; ++slot) {
+            prefixes = static_cast<uint16_t>(prefixes | ((items[slot] >> k_suffix_bits) << (slot * 4)));
+            word |= (uint64_t(items[slot]) & bitmask(k_suffix_bits)) << (k_index_bits + slot * k_suffix_bits);
+        }
+        word_ = static_cast<word_type>(word | semi_sorted_codec::instance().encode[prefixes]);
+    }
+
+   public:
+    semi_sorted_bucket() : word_(0) {
+        static_assert(IC == 4, "Semi-sorted buckets hold 4 fingerprints");
+        static_assert(FB >= 4 && FB <= 17, "Fingerprint bits must be in [4, 17]");
+    }
+
+    //! Fingerprint in \a slot of the sorted bucket, 0 if the slot is empty
+    value_type get(size_t slot) const {
+        value_type items[IC];
+        decode(items);
+        return items[slot];
+    }
+
+    //! Stores \a item in \a slot, 0 empties the slot, the bucket is sorted again
+    void set(size_t slot, value_type item) {
+        value_type items[IC];
+        decode(items);
+        items[slot] = static_cast<value_type>(item & bitmask(FB));
+        encode(items);
+    }
+
+    /*! \brief Insert an item into an empty slot
+     *
+     * \param item - non-zero fingerprint to insert.
+     * \param kick - replace the fingerprint of a slot picked by \a item if the bucket is full.
+     *
+     * \return 0 if the item is inserted into an empty slot, the replaced fingerprint if the
+     * bucket is full and \a kick is set, \a item otherwise.
+     */
+    value_type insert(value_type item, bool kick = false) {
+        value_type items[IC];
+        decode(items);
+        // empty slots sort first
+        if (items[0] == 0) {
+            items[0] = item;
+            encode(items);
+            return 0;
+        }
+        if (!kick) {
+            return item;
+        }
+        size_t victim = ((uint64_t(item) * 0x9E3779B97F4A7C15ULL) >> 32) % IC;
+        value_type kickout_item = items[victim];
+        items[victim] = item;
+        encode(items);
+        return kickout_item;
+    }
+
+    //! Empties one slot holding \a item, if any
+    void erase(value_type item) {
+        value_type items[IC];
+        decode(items);
+        for (size_t slot = 0; slot < IC; ++slot) {
+            if (items[slot] == item) {
+                items[slot] = 0;
+                encode(items);
+                return;
+            }
+        }
+    }
+
+    //! Slot of the sorted bucket holding \a item, IC if there is none
+    size_t find(value_type item) const {
+        value_type items[IC];
+        decode(items);
+        for (size_t slot = 0; slot < IC; ++slot) {
+            if (items[slot] == item) {
+                return slot;
+            }
+        }
+        return IC;
+    }
+
+    //! Whether a slot holds \a item
+    bool contains(value_type item) const {
+        value_type items[IC];
+        decode(items);
+        return items[0] == item || items[1] == item || items[2] == item || items[3] == item;
+    }
+
+    //! Empties all slots
+    void clear() {
+        value_type items[IC] = {};
+        encode(items);
+    }
 };
 
-template <size_t FB, size_t IC, typename S = uint32_t>
+template <size_t FB, size_t IC>
+constexpr size_t semi_sorted_bucket<FB, IC>::k_slots;
+
+/*! \brief Cuckoo Table
+ *
+ * cuckoo_table class keeps a power of two number of buckets of type B in contiguous memory,
+ * either owned by the table or external, e.g. a memory mapped file.
+ *
+ * \tparam FB - Number of bits of each fingerprint (at most 32)
+ * \tparam IC - Number of fingerprints in each bucket
+ * \tparam S - Fingerprint type (default: uint32_t)
+ * \tparam B - Bucket type (default: pdstl::array_bucket)
+ */
+template <size_t FB, size_t IC, typename S = uint32_t, template <size_t, size_t> class B = array_bucket>
 class cuckoo_table : public bucket_info<FB, IC> {
-   private:
-    std::vector<array_bucket<FB, IC>> table_;
-    inline size_t round_up(size_t num) const {
+   public:
+    typedef B<FB, IC> bucket_type;
+
+    //! Smallest power of two greater than or equal to \a num, the number of buckets of a table
+    static size_t round_up(size_t num) {
         num--;
         num |= num >> 1;
         num |= num >> 2;
@@ -103,29 +367,94 @@ class cuckoo_table : public bucket_info<FB, IC> {
         return num;
     }
 
+   private:
+    std::vector<bucket_type> storage_;
+    bucket_type* table_;
+    size_t num_buckets_;
+
    public:
-    explicit cuckoo_table(size_t num_buckets) : bucket_info<FB, IC>(), table_(round_up(num_buckets)) {
-        static_assert(FB > 0 && ((FB - 1) & FB) == 0,
-                      "FB template parameters must be positive power of two number");
+    explicit cuckoo_table(size_t num_buckets) : bucket_info<FB, IC>(), storage_(round_up(num_buckets)), table_(storage_.data()), num_buckets_(storage_.size()) {
+        static_assert(FB > 0 && FB <= 32, "FB template parameter must be in [1, 32]");
+        static_assert(std::is_trivially_copyable<bucket_type>::value, "Buckets must be trivially copyable");
     }
 
-    size_t size() const { return table_.size(); }
+    /*! \brief Constructs a table on top of external memory, e.g. a memory mapped file.
+     *
+     * The table does not own the memory, which must be aligned for buckets and hold
+     * memory_size(num_buckets) bytes laid out by a table with the same number of buckets.
+     *
+     * \param num_buckets - number of buckets, a power of two
+     * \param memory - memory holding the buckets of the table
+     */
+    cuckoo_table(size_t num_buckets, void* memory) : bucket_info<FB, IC>(), table_(static_cast<bucket_type*>(memory)), num_buckets_(num_buckets) {}
+
+    //! Copy constructor, the copy always owns its memory
+    cuckoo_table(const cuckoo_table& other) : bucket_info<FB, IC>(other),
+                                              storage_(other.table_, other.table_ + other.num_buckets_),
+                                              table_(storage_.data()),
+                                              num_buckets_(other.num_buckets_) {}
+
+    //! Move constructor
+    cuckoo_table(cuckoo_table&& other) noexcept : bucket_info<FB, IC>(other),
+                                                  storage_(std::move(other.storage_)),
+                                                  table_(other.table_),
+                                                  num_buckets_(other.num_buckets_) {}
+
+    //! Assignment operator
+    cuckoo_table& operator=(cuckoo_table other) noexcept {
+        storage_.swap(other.storage_);
+        std::swap(table_, other.table_);
+        std::swap(num_buckets_, other.num_buckets_);
+        return *this;
+    }
+
+    //! Bytes of external memory needed by a table of \a num_buckets buckets
+    static size_t memory_size(size_t num_buckets) { return round_up(num_buckets) * sizeof(bucket_type); }
+
+    size_t size() const { return num_buckets_; }
+
+    void clear() {
+        for (size_t index = 0; index < num_buckets_; ++index) {
+            table_[index].clear();
+        }
+    }
+
+    //! Writes the buckets to \a out, in the layout of external memory
+    void save(std::ostream& out) const { write_bytes(out, table_, num_buckets_ * sizeof(bucket_type)); }
+
+    //! Reads buckets written by save from a table with the same number of buckets
+    void load(std::istream& in) { read_bytes(in, table_, num_buckets_ * sizeof(bucket_type)); }
+
+    //! Fingerprint in \a slot of bucket \a index, 0 if the slot is empty
+    S get(size_t index, size_t slot) const { return table_[index].get(slot); }
+
+    //! Stores \a item in \a slot of bucket \a index, 0 empties the slot
+    void set(size_t index, size_t slot, S item) { table_[index].set(slot, item); }
+
+    //! First slot of bucket \a index holding \a item, items_in_bucket if there is none
+    size_t find(size_t index, S item) const { return table_[index].find(item); }
+
+    //! Whether bucket \a index has an empty slot
+    bool has_empty(size_t index) const { return table_[index].contains(0); }
+
+    //! Hints the processor to load bucket \a index into cache
+    void prefetch(size_t index) const { __builtin_prefetch(&table_[index]); }
 
     S insert(size_t index, S item, bool kick = false) {
-        if (index >= table_.size()) {
+        if (index >= num_buckets_) {
             return 0;
         }
         return table_[index].insert(item, kick);
     }
 
     void erase(size_t index, S item) {
-        if (index >= table_.size()) {
+        if (index >= num_buckets_) {
             return;
         }
         table_[index].erase(item);
     }
     bool contains(size_t index, S item) const {
-        if (index >= table_.size()) {
+        if (index >= num_buckets_) {
             return false;
         }
         return table_[index].contains(item);
@@ -135,7 +464,19 @@ class cuckoo_table : public bucket_info<FB, IC> {
 /*! \brief Cuckoo Filter
  *
  * cuckoo_filter class implements cuckoo filter algorithm for solving membership problem.
- * 
+ *
+ * When both buckets of an item are full, insert searches breadth first for the shortest chain of
+ * fingerprints to move, each to its alternate bucket, ending at a bucket with an empty slot
+ * (Li et al., "Algorithmic Improvements for Fast Concurrent Cuckoo Hashing"). The search visits
+ * at most max_kicks buckets and only moves fingerprints once a chain is found, so a failed
+ * search leaves the table unchanged. Short chains touch few buckets, which keeps insert latency
+ * low at high load. Items whose search fails go to a small victim stash, checked by contains
+ * and erase; when the stash is full too the filter is full, and insert throws instead of losing
+ * an item. With 4-slot buckets the filter fills to about 95% of its slots.
+ *
+ * save writes the filter in the versioned format of serialized_header, load reads it back into
+ * memory and open maps a saved file to serve lookups from it without copying the table.
+ *
  * \tparam CT - cuckoo table
  * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
  * \tparam T - Element type which will be inserted into cuckoo filter (default: std::string)
@@ -147,35 +488,122 @@ template <
     typename T = std::string,
     typename S = uint32_t>
 class cuckoo_filter : public membership<T> {
-   private:
-    bool add_item_to_bucket(size_t index, S item);
-
    protected:
+    static constexpr size_t k_stash_size = 4;
+    static constexpr size_t k_batch_size = 16;
+    static constexpr size_t k_no_parent = ~size_t(0);
+
+    //! Bucket of the eviction search, reached by moving \a finger_print out of bucket \a parent
+    struct path_node {
+        size_t index;
+        size_t parent;
+        S finger_print;
+    };
+
     std::unique_ptr<HF<T, S>> finger_print_factory_;
     std::unique_ptr<hash<T, S>> finger_print_;
     std::unique_ptr<HF<S, S>> hash_factory_;
     std::unique_ptr<hash<S, S>> hash_;
     CT table_;
     const size_t k_max_kicks_;
+    std::vector<std::pair<size_t, S>> stash_;
+    size_t num_items_;
+    std::shared_ptr<mapped_file> file_;
+
+    /*! \brief Constructor of a saved filter
+     *
+     * \param table - table of the filter
+     * \param saved - header of the saved filter, checked by expected_header
+     */
+    cuckoo_filter(CT&& table, const serialized_header& saved);
+
+    //! Header with the structure, hash functions and geometry of filters of this type
+    static serialized_header expected_header();
+
+    //! Checks the header of a saved filter, returns its number of buckets
+    static size_t check_header(const serialized_header& saved);
+
+    //! Restores the stash from the \a saved number of 64-bit (bucket, fingerprint) pairs at \a entries, which may be unaligned
+    void load_stash(const serialized_header& saved, const void* entries);
+
+    //! Non-zero fingerprint from the high bits of \a hash_value, 0 marks empty slots
+    inline S make_finger_print(S hash_value) const {
+        S finger_print = static_cast<S>((hash_value >> (sizeof(S) * 8 - table_.finger_print_bits)) & bitmask(table_.finger_print_bits));
+        return finger_print == 0 ? 1 : finger_print;
+    }
+    inline size_t alternate_index(size_t index, S finger_print) const { return index ^ (hash_->value(finger_print) & (table_.size() - 1)); }
+
+    //! First bucket \a index and fingerprint \a finger_print of \a item
+    inline void locate(const T& item, size_t& index, S& finger_print) const {
+        S hash_value = finger_print_->value(item);
+        finger_print = make_finger_print(hash_value);
+        index = hash_value & (table_.size() - 1);
+    }
+
+    //! Inserts \a finger_print into bucket \a index or its alternate, evicting or stashing if needed
+    bool insert_finger_print(size_t index, S finger_print);
+
+    //! Inserts \a finger_print into bucket \a index or its alternate if one has an empty slot
+    bool place_finger_print(size_t index, S finger_print);
+
+    //! Erases one copy of \a finger_print of bucket \a index, returns false if there is none
+    bool erase_finger_print(size_t index, S finger_print);
+
+    //! Whether \a finger_print is in bucket \a index, its alternate or the stash
+    bool contains_finger_print(size_t index, S finger_print) const {
+        return contains_finger_print(index, alternate_index(index, finger_print), finger_print);
+    }
+
+    //! Whether \a finger_print is in bucket \a index, bucket \a alternate or the stash
+    bool contains_finger_print(size_t index, size_t alternate, S finger_print) const;
+
+    //! Makes room for \a finger_print in bucket \a i or \a j along the shortest eviction path
+    bool evict(size_t i, size_t j, S finger_print);
+
+    //! Whether \a index is the bucket of \a node or of one of its ancestors
+    bool on_path(const std::vector<path_node>& nodes, size_t node, size_t index) const;
+
+    //! Moves stashed fingerprints whose buckets have an empty slot back into the table
+    void drain_stash();
 
    public:
     /*! \brief Default constructor
      *
      * \param num_buckets - number of buckets in this filter
+     * \param max_kicks - maximum number of buckets visited when searching for an eviction path
      */
     explicit cuckoo_filter(size_t num_buckets, size_t max_kicks);
 
-    /*! \brief insert an item into quotient filter
+    /*! \brief Constructor with given hash seeds
      *
-     * \param item - the item to insert into the quotient filter.
-     * 
+     * \param num_buckets - number of buckets in this filter
+     * \param max_kicks - maximum number of buckets visited when searching for an eviction path
+     * \param finger_print_seed - seed of the hash function of items
+     * \param hash_seed - seed of the hash function of fingerprints, which picks alternate buckets
+     */
+    cuckoo_filter(size_t num_buckets, size_t max_kicks, S finger_print_seed, S hash_seed);
+
+    /*! \brief insert an item into cuckoo filter
+     *
+     * Throws capacity_exceeded_exception if the filter is full.
+     *
+     * \param item - the item to insert into the cuckoo filter.
      */
     void insert(const T& item) override;
 
-    /*! \brief Erase is not supported in standard quotient filter. will throw an exception
+    /*! \brief insert an item into cuckoo filter if there is room for it
+     *
+     * \param item - the item to insert into the cuckoo filter.
+     *
+     * \return true if the item is inserted, false if the filter is full and is left unchanged.
+     */
+    bool try_insert(const T& item);
+
+    /*! \brief Erase an item from cuckoo filter
+     *
+     * Erasing an item which was not inserted may remove another item with the same fingerprint.
      *
      * \param item - the item to erase from filter.
-     * 
      */
     void erase(const T& item) override;
 
@@ -189,8 +617,60 @@ class cuckoo_filter : public membership<T> {
      * \return false if the item is not in the filter, true if item may be in the filter.
      */
     bool contains(const T& item) const override;
+
+    /*! \brief Check a group of items for existence in the filter.
+     *
+     * Items are looked up in batches: the fingerprints and both buckets of a batch are computed
+     * and prefetched first, then the buckets are probed, so the cache misses of a batch overlap
+     * instead of following each other. This pays off for tables much larger than the cache.
+     *
+     * \param first - iterator to the first item to check.
+     * \param last - iterator past the last item to check.
+     *
+     * \return bitmap with one bit per item, false if the item is not in the filter, true if it
+     * may be in the filter.
+     */
+    template <typename I>
+    std::vector<bool> contains(I first, I last) const;
+
+    //! \brief Number of items in the filter.
+    size_t size() const { return num_items_; }
+
+    /*! \brief Write the filter to a stream.
+     *
+     * \param out - the stream to write to.
+     */
+    void save(std::ostream& out) const;
+
+    /*! \brief Read a filter written by save.
+     *
+     * Throws invalid_format_exception if the stream is truncated or holds another structure, or
+     * a filter with other bucket geometry or hash functions.
+     *
+     * \param in - the stream to read from.
+     */
+    static cuckoo_filter load(std::istream& in);
+
+    /*! \brief Map a file written by save, without copying its table.
+     *
+     * Lookups read the table from the page cache, which is shared by every process mapping the
+     * file. The filter may still be modified, modified pages are copied and never written to the
+     * file. Throws like load, and std::system_error if the file can not be mapped.
+     *
+     * \param path - path of the file.
+     */
+    static cuckoo_filter open(const std::string& path);
 };
 
+template <typename CT, template <typename...> class HF, typename T, typename S>
+constexpr size_t cuckoo_filter<CT, HF, T, S>::k_stash_size;
+
+template <typename CT, template <typename...> class HF, typename T, typename S>
+constexpr size_t cuckoo_filter<CT, HF, T, S>::k_batch_size;
+
+template <typename CT, template <typename...> class HF, typename T, typename S>
+constexpr size_t cuckoo_filter<CT, HF, T, S>::k_no_parent;
+
 #define CLASS_METHOD_IMPL(method_name, ...) \
     template <                              \
         typename CT,                        \
@@ -203,49 +683,285 @@ CLASS_METHOD_IMPL(cuckoo_filter, )
 (size_t num_buckets, size_t max_kicks) : finger_print_factory_(std::make_unique<HF<T, S>>()),
                                          hash_factory_(std::make_unique<HF<S, S>>()),
                                          table_(num_buckets),
-                                         k_max_kicks_(max_kicks) {
+                                         k_max_kicks_(max_kicks),
+                                         num_items_(0) {
     hash_ = hash_factory_->create_hash();
     finger_print_ = finger_print_factory_->create_hash();
+    stash_.reserve(k_stash_size);
+}
+
+CLASS_METHOD_IMPL(cuckoo_filter, )
+(size_t num_buckets, size_t max_kicks, S finger_print_seed, S hash_seed) : finger_print_factory_(std::make_unique<HF<T, S>>()),
+                                                                           hash_factory_(std::make_unique<HF<S, S>>()),
+                                                                           table_(num_buckets),
+                                                                           k_max_kicks_(max_kicks),
+                                                                           num_items_(0) {
+    hash_ = hash_factory_->create_hash(hash_seed);
+    finger_print_ = finger_print_factory_->create_hash(finger_print_seed);
+    stash_.reserve(k_stash_size);
+}
+
+CLASS_METHOD_IMPL(cuckoo_filter, )
+(CT&& table, const serialized_header& saved) : finger_print_factory_(std::make_unique<HF<T, S>>()),
+                                               hash_factory_(std::make_unique<HF<S, S>>()),
+                                               table_(std::move(table)),
+                                               k_max_kicks_(saved.shape[1]),
+                                               num_items_(saved.count) {
+    hash_ = hash_factory_->create_hash(static_cast<S>(saved.seeds[1]));
+    finger_print_ = finger_print_factory_->create_hash(static_cast<S>(saved.seeds[0]));
+    stash_.reserve(k_stash_size);
 }
 
 CLASS_METHOD_IMPL(insert, void)
 (const T& item) {
-    S finger_print = finger_print_->value(item) % (1 << table_.finger_print_bits);
-    S i = finger_print_->value(item) & (table_.size() - 1);
-    S j = i ^ (hash_->value(finger_print) & (table_.size() - 1));
-    if (table_.insert(i, finger_print) == 0 || table_.insert(j, finger_print) == 0) {
-        return;
-    }
-    S cur_index = j;
-    for (int n = 0; n < k_max_kicks_; ++n) {
-        finger_print = table_.insert(cur_index, finger_print);
-        if (finger_print == 0) {
-            return;
-        }
-        cur_index = cur_index ^ (hash_->value(finger_print) & (table_.size() - 1));
+    if (!try_insert(item)) {
+        throw capacity_exceeded_exception();
     }
 }
 
+CLASS_METHOD_IMPL(try_insert, bool)
+(const T& item) {
+    size_t index;
+    S finger_print;
+    locate(item, index, finger_print);
+    return insert_finger_print(index, finger_print);
+}
+
 CLASS_METHOD_IMPL(erase, void)
 (const T& item) {
-    S finger_print = finger_print_->value(item) % (1 << table_.finger_print_bits);
-    S i = finger_print_->value(item) & (table_.size() - 1);
-    S j = i ^ (hash_->value(finger_print) & (table_.size() - 1));
-    table_.erase(i, finger_print);
-    table_.erase(j, finger_print);
+    size_t index;
+    S finger_print;
+    locate(item, index, finger_print);
+    erase_finger_print(index, finger_print);
 }
 
 CLASS_METHOD_IMPL(clear, void)
 () {
-    // table_.clear();
+    table_.clear();
+    stash_.clear();
+    num_items_ = 0;
 }
 
 CLASS_METHOD_IMPL(contains, bool)
 (const T& item) const {
-    S finger_print = finger_print_->value(item) % (1 << table_.finger_print_bits);
-    S i = finger_print_->value(item) & (table_.size() - 1);
-    S j = i ^ (hash_->value(finger_print) & (table_.size() - 1));
-    return table_.contains(i, finger_print) || table_.contains(j, finger_print);
+    size_t index;
+    S finger_print;
+    locate(item, index, finger_print);
+    return contains_finger_print(index, finger_print);
+}
+
+CLASS_METHOD_IMPL(insert_finger_print, bool)
+(size_t index, S finger_print) {
+    if (place_finger_print(index, finger_print)) {
+        return true;
+    }
+    if (evict(index, alternate_index(index, finger_print), finger_print)) {
+        ++num_items_;
+        return true;
+    }
+    if (stash_.size() < k_stash_size) {
+        stash_.emplace_back(index, finger_print);
+        ++num_items_;
+        return true;
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(place_finger_print, bool)
+(size_t index, S finger_print) {
+    if (table_.insert(index, finger_print) == 0 || table_.insert(alternate_index(index, finger_print), finger_print) == 0) {
+        ++num_items_;
+        return true;
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(erase_finger_print, bool)
+(size_t index, S finger_print) {
+    size_t alternate = alternate_index(index, finger_print);
+    for (auto stashed = stash_.begin(); stashed != stash_.end(); ++stashed) {
+        if (stashed->second == finger_print && (stashed->first == index || stashed->first == alternate)) {
+            stash_.erase(stashed);
+            --num_items_;
+            return true;
+        }
+    }
+    if (table_.contains(index, finger_print)) {
+        table_.erase(index, finger_print);
+    } else if (table_.contains(alternate, finger_print)) {
+        table_.erase(alternate, finger_print);
+    } else {
+        return false;
+    }
+    --num_items_;
+    drain_stash();
+    return true;
+}
+
+template <typename CT, template <typename...> class HF, typename T, typename S>
+template <typename I>
+std::vector<bool> cuckoo_filter<CT, HF, T, S>::contains(I first, I last) const {
+    std::vector<bool> result;
+    size_t indexes[k_batch_size];
+    size_t alternates[k_batch_size];
+    S finger_prints[k_batch_size];
+    while (first != last) {
+        size_t batch_size = 0;
+        for (; batch_size < k_batch_size && first != last; ++batch_size, ++first) {
+            locate(*first, indexes[batch_size], finger_prints[batch_size]);
+            alternates[batch_size] = alternate_index(indexes[batch_size], finger_prints[batch_size]);
+            table_.prefetch(indexes[batch_size]);
+            table_.prefetch(alternates[batch_size]);
+        }
+        for (size_t item = 0; item < batch_size; ++item) {
+            result.push_back(contains_finger_print(indexes[item], alternates[item], finger_prints[item]));
+        }
+    }
+    return result;
+}
+
+CLASS_METHOD_IMPL(contains_finger_print, bool)
+(size_t index, size_t alternate, S finger_print) const {
+    if (table_.contains(index, finger_print) || table_.contains(alternate, finger_print)) {
+        return true;
+    }
+    for (const auto& stashed : stash_) {
+        if (stashed.second == finger_print && (stashed.first == index || stashed.first == alternate)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(evict, bool)
+(size_t i, size_t j, S finger_print) {
+    std::vector<path_node> nodes;
+    nodes.reserve(k_max_kicks_ + 2);
+    nodes.push_back({i, k_no_parent, 0});
+    nodes.push_back({j, k_no_parent, 0});
+    for (size_t node = 0; node < nodes.size() && nodes.size() < k_max_kicks_ + 2; ++node) {
+        for (size_t slot = 0; slot < table_.items_in_bucket && nodes.size() < k_max_kicks_ + 2; ++slot) {
+            S moved = table_.get(nodes[node].index, slot);
+            size_t index = alternate_index(nodes[node].index, moved);
+            if (on_path(nodes, node, index)) {
+                continue;
+            }
+            nodes.push_back({index, node, moved});
+            if (!table_.has_empty(index)) {
+                continue;
+            }
+            // move fingerprints from the end of the path, each into the slot freed after it
+            size_t child = nodes.size() - 1;
+            table_.insert(index, moved);
+            while (true) {
+                size_t parent = nodes[child].parent;
+                bool root = nodes[parent].parent == k_no_parent;
+                table_.erase(nodes[parent].index, nodes[child].finger_print);
+                table_.insert(nodes[parent].index, root ? finger_print : nodes[parent].finger_print);
+                if (root) {
+                    return true;
+                }
+                child = parent;
+            }
+        }
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(on_path, bool)
+(const std::vector<path_node>& nodes, size_t node, size_t index) const {
+    for (; node != k_no_parent; node = nodes[node].parent) {
+        if (nodes[node].index == index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(drain_stash, void)
+() {
+    for (auto stashed = stash_.begin(); stashed != stash_.end();) {
+        if (table_.insert(stashed->first, stashed->second) == 0 ||
+            table_.insert(alternate_index(stashed->first, stashed->second), stashed->second) == 0) {
+            stashed = stash_.erase(stashed);
+        } else {
+            ++stashed;
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(save, void)
+(std::ostream& out) const {
+    serialized_header saved = expected_header();
+    saved.seeds[0] = finger_print_->seed();
+    saved.seeds[1] = hash_->seed();
+    saved.shape[0] = table_.size();
+    saved.shape[1] = k_max_kicks_;
+    saved.shape[2] = stash_.size();
+    saved.count = num_items_;
+    write_bytes(out, &saved, sizeof(saved));
+    table_.save(out);
+    for (const auto& stashed : stash_) {
+        uint64_t entry[2] = {stashed.first, stashed.second};
+        write_bytes(out, entry, sizeof(entry));
+    }
+}
+
+CLASS_METHOD_IMPL(load, cuckoo_filter<CT, HF, T, S>)
+(std::istream& in) {
+    serialized_header saved = read_header(in);
+    cuckoo_filter filter(CT(check_header(saved)), saved);
+    filter.table_.load(in);
+    std::vector<uint64_t> entries(saved.shape[2] * 2);
+    read_bytes(in, entries.data(), entries.size() * sizeof(uint64_t));
+    filter.load_stash(saved, entries.data());
+    return filter;
+}
+
+CLASS_METHOD_IMPL(open, cuckoo_filter<CT, HF, T, S>)
+(const std::string& path) {
+    auto file = std::make_shared<mapped_file>(path);
+    serialized_header saved = read_header(file->data(), file->size());
+    size_t num_buckets = check_header(saved);
+    size_t table_size = CT::memory_size(num_buckets);
+    if (file->size() < sizeof(saved) + table_size + saved.shape[2] * 2 * sizeof(uint64_t)) {
+        throw invalid_format_exception("truncated input");
+    }
+    file->advise_random();
+    uint8_t* memory = static_cast<uint8_t*>(file->data()) + sizeof(saved);
+    cuckoo_filter filter(CT(num_buckets, memory), saved);
+    filter.load_stash(saved, memory + table_size);
+    filter.file_ = std::move(file);
+    return filter;
+}
+
+CLASS_METHOD_IMPL(expected_header, serialized_header)
+() {
+    const CT info(1);
+    serialized_header expected("cuckoo_filter", HF<T, S>().family(), sizeof(S) * 8);
+    expected.geometry[0] = info.finger_print_bits;
+    expected.geometry[1] = info.items_in_bucket;
+    expected.geometry[2] = CT::bucket_type::k_layout;
+    return expected;
+}
+
+CLASS_METHOD_IMPL(check_header, size_t)
+(const serialized_header& saved) {
+    expected_header().check(saved);
+    size_t num_buckets = saved.shape[0];
+    if (num_buckets == 0 || CT::round_up(num_buckets) != num_buckets || saved.shape[2] > k_stash_size) {
+        throw invalid_format_exception("geometry does not match");
+    }
+    return num_buckets;
+}
+
+CLASS_METHOD_IMPL(load_stash, void)
+(const serialized_header& saved, const void* entries) {
+    for (size_t entry = 0; entry < saved.shape[2]; ++entry) {
+        uint64_t stashed[2];
+        std::memcpy(stashed, static_cast<const uint8_t*>(entries) + entry * sizeof(stashed), sizeof(stashed));
+        stash_.emplace_back(static_cast<size_t>(stashed[0]), static_cast<S>(stashed[1]));
+    }
 }
 
 #undef CLASS_METHOD_IMPL
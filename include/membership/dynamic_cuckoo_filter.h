@@ -0,0 +1,228 @@
+#ifndef INCLUDE_MEMBERSHIP_DYNAMIC_CUCKOO_FILTER_H_
+#define INCLUDE_MEMBERSHIP_DYNAMIC_CUCKOO_FILTER_H_
+
+#include <hash/mmh3_hash_factory.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cuckoo_filter.h"
+#include "membership.h"
+
+namespace pdstl {
+
+/*! \brief Dynamic Cuckoo Filter
+ *
+ * dynamic_cuckoo_filter class implements a cuckoo filter which grows with the number of items
+ * (Chen et al., "The Dynamic Cuckoo Filter"). It is a list of cuckoo_filter segments with the
+ * same number of buckets and the same hash seeds, so an item has the same fingerprint and
+ * buckets in every segment. When an item does not fit into the last segment, a new segment is
+ * linked, so memory grows in steps of one segment instead of doubling.
+ *
+ * insert first tries the buckets of the item in every segment, which reuses slots freed by
+ * erase, before evicting in the last segment. contains and erase check all segments. Segments
+ * emptied by erase are unlinked, and compact moves fingerprints out of the last segments into
+ * free slots of the others to unlink sparse segments after many erases.
+ *
+ * \tparam CT - cuckoo table of each segment
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into dynamic cuckoo filter (default: std::string)
+ * \tparam S - Hash output type (default: uint32_t)
+ */
+template <
+    typename CT,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string,
+    typename S = uint32_t>
+class dynamic_cuckoo_filter : public membership<T> {
+   protected:
+    //! Cuckoo filter segment which exposes its fingerprint operations to the dynamic filter
+    class segment : public cuckoo_filter<CT, HF, T, S> {
+       private:
+        typedef cuckoo_filter<CT, HF, T, S> base;
+
+       public:
+        using base::base;
+
+        //! New empty segment with the same geometry and hash seeds as this one
+        std::unique_ptr<segment> sibling() const {
+            return std::make_unique<segment>(this->table_.size(), this->k_max_kicks_, this->finger_print_->seed(), this->hash_->seed());
+        }
+
+        using base::contains_finger_print;
+        using base::erase_finger_print;
+        using base::insert_finger_print;
+        using base::locate;
+        using base::place_finger_print;
+
+        //! Moves the fingerprints which fit into the buckets of \a target without eviction
+        void move_into(segment& target);
+    };
+
+    std::vector<std::unique_ptr<segment>> segments_;
+
+   public:
+    /*! \brief Default constructor
+     *
+     * \param num_buckets - number of buckets in each segment
+     * \param max_kicks - maximum number of buckets visited when searching for an eviction path
+     */
+    dynamic_cuckoo_filter(size_t num_buckets, size_t max_kicks);
+
+    /*! \brief insert an item into dynamic cuckoo filter, linking a new segment if needed
+     *
+     * \param item - the item to insert into the dynamic cuckoo filter.
+     */
+    void insert(const T& item) override;
+
+    /*! \brief Erase an item from dynamic cuckoo filter
+     *
+     * Erasing an item which was not inserted may remove another item with the same fingerprint.
+     *
+     * \param item - the item to erase from filter.
+     */
+    void erase(const T& item) override;
+
+    //! \brief Clear filter and resets its internal memory, keeping one segment.
+    void clear() override;
+
+    /*! \brief Check the item and report that it's in the filter or not.
+     *
+     * \param item - the item to check for existence.
+     *
+     * \return false if the item is not in the filter, true if item may be in the filter.
+     */
+    bool contains(const T& item) const override;
+
+    //! \brief Move fingerprints of the last segments into free slots of the others, unlinking emptied segments.
+    void compact();
+
+    //! \brief Number of items in the filter.
+    size_t size() const;
+
+    //! \brief Number of linked segments.
+    size_t num_segments() const { return segments_.size(); }
+};
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        typename CT,                        \
+        template <typename...> class HF,    \
+        typename T,                         \
+        typename S>                         \
+    __VA_ARGS__ dynamic_cuckoo_filter<CT, HF, T, S>::method_name
+
+CLASS_METHOD_IMPL(dynamic_cuckoo_filter, )
+(size_t num_buckets, size_t max_kicks) {
+    segments_.push_back(std::make_unique<segment>(num_buckets, max_kicks));
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item) {
+    size_t index;
+    S finger_print;
+    segments_.front()->locate(item, index, finger_print);
+    for (auto& a_segment : segments_) {
+        if (a_segment->place_finger_print(index, finger_print)) {
+            return;
+        }
+    }
+    if (segments_.back()->insert_finger_print(index, finger_print)) {
+        return;
+    }
+    segments_.push_back(segments_.front()->sibling());
+    segments_.back()->place_finger_print(index, finger_print);
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(const T& item) {
+    size_t index;
+    S finger_print;
+    segments_.front()->locate(item, index, finger_print);
+    for (auto a_segment = segments_.begin(); a_segment != segments_.end(); ++a_segment) {
+        if ((*a_segment)->erase_finger_print(index, finger_print)) {
+            if ((*a_segment)->size() == 0 && segments_.size() > 1) {
+                segments_.erase(a_segment);
+            }
+            return;
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    segments_.resize(1);
+    segments_.front()->clear();
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(const T& item) const {
+    size_t index;
+    S finger_print;
+    segments_.front()->locate(item, index, finger_print);
+    for (const auto& a_segment : segments_) {
+        if (a_segment->contains_finger_print(index, finger_print)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(compact, void)
+() {
+    for (size_t source = segments_.size(); source-- > 1;) {
+        for (size_t target = 0; target < segments_.size() && segments_[source]->size() > 0; ++target) {
+            if (target != source) {
+                segments_[source]->move_into(*segments_[target]);
+            }
+        }
+        if (segments_[source]->size() == 0) {
+            segments_.erase(segments_.begin() + source);
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(size, size_t)
+() const {
+    size_t num_items = 0;
+    for (const auto& a_segment : segments_) {
+        num_items += a_segment->size();
+    }
+    return num_items;
+}
+
+CLASS_METHOD_IMPL(segment::move_into, void)
+(segment& target) {
+    std::vector<S> finger_prints;
+    for (size_t index = 0; index < this->table_.size(); ++index) {
+        finger_prints.clear();
+        for (size_t slot = 0; slot < this->table_.items_in_bucket; ++slot) {
+            S finger_print = this->table_.get(index, slot);
+            if (finger_print != 0) {
+                finger_prints.push_back(finger_print);
+            }
+        }
+        for (S finger_print : finger_prints) {
+            if (target.place_finger_print(index, finger_print)) {
+                this->table_.erase(index, finger_print);
+                --this->num_items_;
+            }
+        }
+    }
+    for (auto stashed = this->stash_.begin(); stashed != this->stash_.end();) {
+        if (target.place_finger_print(stashed->first, stashed->second)) {
+            stashed = this->stash_.erase(stashed);
+            --this->num_items_;
+        } else {
+            ++stashed;
+        }
+    }
+    this->drain_stash();
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_MEMBERSHIP_DYNAMIC_CUCKOO_FILTER_H_
@@ -1,13 +1,22 @@
 #ifndef INCLUDE_MEMBERSHIP_QUOTIENT_FILTER_H_
 #define INCLUDE_MEMBERSHIP_QUOTIENT_FILTER_H_
 
-#include <exception/not_supported.h>
+#include <exception/invalid_format.h>
 #include <hash/mmh3_hash_factory.h>
+#include <io/mapped_file.h>
+#include <io/serialization.h>
 #include <table/quotient_table.h>
+#include <utils/bits.h>
+#include <utils/radix_sort.h>
 
 #include <algorithm>
+#include <istream>
+#include <iterator>
 #include <memory>
+#include <ostream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "membership.h"
@@ -17,37 +26,100 @@ namespace pdstl {
 /*! \brief Quotient Filter
  *
  * quotient_filter class implements quotient filter algorithm for solving membership problem.
+ *
+ * The filter starts with 2^Q slots. When an insert would exceed the maximum load factor, the
+ * table is scanned in fingerprint order and rebuilt with one more quotient bit (and one less
+ * remainder bit), without rehashing the inserted items. Once the remainder can not give up any
+ * more bits, inserting into a full table throws capacity_exceeded_exception.
+ *
+ * Items with the same fingerprint take one slot each, so erasing one of them keeps the others.
+ *
+ * save writes the filter in the versioned format of serialized_header, load reads it back into
+ * memory and open maps a saved file to serve lookups from it without copying the table.
  * 
  * \tparam F - Fingerprint bits, must be smaller than or equal to hash output size
- * \tparam Q - Number of bits for quotient part, remainder bit size is (F - Q)
+ * \tparam Q - Initial number of bits for quotient part, remainder bit size is (F - Q)
  * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
  * \tparam T - Element type which will be inserted into quotient filter (default: std::string)
  * \tparam S - Hash output type (default: uint32_t)
+ * \tparam P - Pack remainders into (F - Q)-bit fields of the table (default: false)
  */
 template <
     std::size_t F,
     std::size_t Q,
     template <typename...> class HF = mmh3_hash_factory,
     typename T = std::string,
-    typename S = uint32_t>
+    typename S = uint32_t,
+    bool P = false>
 class quotient_filter : public membership<T> {
    protected:
+    //! Remainders of repeated fingerprints are kept once per insert, so erase removes one of them
+    typedef quotient_table<S, F - Q, P, true> table_type;
+
     std::unique_ptr<HF<T, S>> hash_factory_;
     std::unique_ptr<hash<T, S>> hash_;
-    quotient_table<S, F - Q> table_;
+    table_type table_;
+    std::size_t quotient_bits_;
+    const float k_max_load_factor_;
+    std::shared_ptr<mapped_file> file_;
+
+    inline S fingerprint(const T& item) const { return static_cast<S>(hash_->value(item) & bitmask(F)); }
+    inline std::size_t quotient(S fingerprint) const { return fingerprint >> (F - quotient_bits_); }
+    inline S remainder(S fingerprint) const { return fingerprint & bitmask(F - quotient_bits_); }
+
+    //! Rebuilds the table with one more quotient bit
+    void expand();
+
+    //! Header of the filter in the serialized format
+    serialized_header header() const;
+
+    //! Filter with the hash seed and quotient size of \a saved, its table is left to the caller
+    static quotient_filter restore(const serialized_header& saved, float max_load_factor);
 
    public:
-    //! Default constructor
-    quotient_filter();
+    /*! \brief Default constructor
+     *
+     * \param max_load_factor - fraction of slots in use that triggers expansion (default: 0.95)
+     */
+    explicit quotient_filter(float max_load_factor = 0.95f);
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * Filters built with the same seed can be merged.
+     *
+     * \param max_load_factor - fraction of slots in use that triggers expansion
+     * \param seed - seed of the hash function
+     */
+    quotient_filter(float max_load_factor, S seed);
+
+    /*! \brief Bulk-load constructor
+     *
+     * Hashes the items on several threads, sorts their fingerprints with a radix sort and lays
+     * out the table in one sequential pass, which is much faster than inserting them one by
+     * one. The quotient gets enough bits, starting from Q, to keep the items under the maximum
+     * load factor.
+     *
+     * \param first - iterator to the first item.
+     * \param last - iterator past the last item.
+     * \param max_load_factor - fraction of slots in use that triggers expansion (default: 0.95)
+     * \param num_threads - number of hashing threads, 0 for one per hardware thread (default: 0)
+     */
+    template <typename I>
+    quotient_filter(I first, I last, float max_load_factor = 0.95f, std::size_t num_threads = 0);
 
     /*! \brief insert an item into quotient filter
+     *
+     * Throws capacity_exceeded_exception if the filter is full and can not expand.
      *
      * \param item - the item to insert into the quotient filter.
      * 
      */
     void insert(const T& item) override;
 
-    /*! \brief Erase is not supported in standard quotient filter. will throw an exception
+    /*! \brief Erase an item from quotient filter
+     *
+     * Erases one insert of the item. Items sharing its fingerprint stay in the filter, but
+     * erasing an item which was not inserted may remove another item with the same fingerprint.
      *
      * \param item - the item to erase from filter.
      * 
@@ -64,6 +136,44 @@ class quotient_filter : public membership<T> {
      * \return false if the item is not in the filter, true if item may be in the filter.
      */
     bool contains(const T& item) const override;
+
+    /*! \brief Merge items of another quotient filter into this filter.
+     *
+     * Both tables are scanned in fingerprint order and the merged table is written in one
+     * sequential pass. The filters may have different quotient sizes, the merged filter gets the
+     * larger one, expanded further if needed to stay under the maximum load factor.
+     * Throws std::invalid_argument if the filters use different hash seeds.
+     *
+     * \param other - the filter to merge into this filter.
+     */
+    void merge(const quotient_filter& other);
+
+    /*! \brief Write the filter to a stream.
+     *
+     * \param out - the stream to write to.
+     */
+    void save(std::ostream& out) const;
+
+    /*! \brief Read a filter written by save.
+     *
+     * Throws invalid_format_exception if the stream is truncated or holds another structure, or
+     * a filter with other template arguments or hash functions.
+     *
+     * \param in - the stream to read from.
+     * \param max_load_factor - fraction of slots in use that triggers expansion (default: 0.95)
+     */
+    static quotient_filter load(std::istream& in, float max_load_factor = 0.95f);
+
+    /*! \brief Map a file written by save, without copying its table.
+     *
+     * Lookups read the table from the page cache, which is shared by every process mapping the
+     * file. The filter may still be modified, modified pages are copied and never written to the
+     * file. Throws like load, and std::system_error if the file can not be mapped.
+     *
+     * \param path - path of the file.
+     * \param max_load_factor - fraction of slots in use that triggers expansion (default: 0.95)
+     */
+    static quotient_filter open(const std::string& path, float max_load_factor = 0.95f);
 };
 
 #define CLASS_METHOD_IMPL(method_name, ...) \
@@ -72,41 +182,200 @@ class quotient_filter : public membership<T> {
         std::size_t Q,                      \
         template <typename...> class HF,    \
         typename T,                         \
-        typename S>                         \
-    __VA_ARGS__ quotient_filter<F, Q, HF, T, S>::method_name
+        typename S,                         \
+        bool P>                             \
+    __VA_ARGS__ quotient_filter<F, Q, HF, T, S, P>::method_name
 
 CLASS_METHOD_IMPL(quotient_filter, )
-() : table_(1 << Q) {
+(float max_load_factor) : table_(std::size_t(1) << Q), quotient_bits_(Q), k_max_load_factor_(max_load_factor) {
     static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
     static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
     hash_factory_ = std::make_unique<HF<T, S>>();
     hash_ = hash_factory_->create_hash();
 }
 
+CLASS_METHOD_IMPL(quotient_filter, )
+(float max_load_factor, S seed) : table_(std::size_t(1) << Q), quotient_bits_(Q), k_max_load_factor_(max_load_factor) {
+    static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
+    static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
+    hash_factory_ = std::make_unique<HF<T, S>>();
+    hash_ = hash_factory_->create_hash(seed);
+}
+
+template <
+    std::size_t F,
+    std::size_t Q,
+    template <typename...> class HF,
+    typename T,
+    typename S,
+    bool P>
+template <typename I>
+quotient_filter<F, Q, HF, T, S, P>::quotient_filter(I first, I last, float max_load_factor, std::size_t num_threads)
+    : quotient_filter(max_load_factor) {
+    std::size_t count = std::distance(first, last);
+    std::vector<S> fingerprints(count);
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::max<std::size_t>(1, std::min(num_threads, count / 4096));
+    std::size_t chunk_size = (count + num_threads - 1) / num_threads;
+    auto hash_chunk = [this, &fingerprints](I chunk_first, std::size_t chunk_start, std::size_t chunk_end) {
+        for (std::size_t index = chunk_start; index < chunk_end; ++index, ++chunk_first) {
+            fingerprints[index] = fingerprint(*chunk_first);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t chunk_start = chunk_size; chunk_start < count; chunk_start += chunk_size) {
+        I chunk_first = first;
+        std::advance(chunk_first, chunk_start);
+        threads.emplace_back(hash_chunk, chunk_first, chunk_start, std::min(chunk_start + chunk_size, count));
+    }
+    hash_chunk(first, 0, std::min(chunk_size, count));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    radix_sort(fingerprints);
+
+    while (count > k_max_load_factor_ * (std::size_t(1) << quotient_bits_) && quotient_bits_ + 1 < F) {
+        ++quotient_bits_;
+    }
+    table_ = table_type(std::size_t(1) << quotient_bits_);
+    for (S fp : fingerprints) {
+        table_.push_back(quotient(fp), remainder(fp));
+    }
+}
+
 CLASS_METHOD_IMPL(insert, void)
 (const T& item) {
-    auto fingerprint = hash_->value(item) % (1 << F);
-    auto quotient = fingerprint >> (F - Q);
-    auto remainder = fingerprint & ((1 << (F - Q)) - 1);
-    table_.insert(quotient, remainder);
+    if (table_.size() + 1 > k_max_load_factor_ * table_.capacity() && quotient_bits_ + 1 < F) {
+        expand();
+    }
+    S fp = fingerprint(item);
+    table_.insert(quotient(fp), remainder(fp));
 }
 
 CLASS_METHOD_IMPL(erase, void)
-(const T& /* item */) {
-    throw not_supported_exception();
+(const T& item) {
+    S fp = fingerprint(item);
+    table_.erase(quotient(fp), remainder(fp));
 }
 
 CLASS_METHOD_IMPL(clear, void)
 () {
-    table_.clear();
+    table_ = table_type(std::size_t(1) << Q);
+    quotient_bits_ = Q;
 }
 
 CLASS_METHOD_IMPL(contains, bool)
 (const T& item) const {
-    auto fingerprint = hash_->value(item) % (1 << F);
-    auto quotient = fingerprint >> (F - Q);
-    auto remainder = fingerprint & ((1 << (F - Q)) - 1);
-    return table_.contains(quotient, remainder);
+    S fp = fingerprint(item);
+    return table_.contains(quotient(fp), remainder(fp));
+}
+
+CLASS_METHOD_IMPL(expand, void)
+() {
+    std::size_t remainder_bits = F - quotient_bits_ - 1;
+    table_type expanded(table_.capacity() * 2);
+    table_.for_each([&expanded, remainder_bits](std::size_t key, S value) {
+        expanded.push_back((key << 1) | (value >> remainder_bits), value & bitmask(remainder_bits));
+    });
+    table_ = std::move(expanded);
+    ++quotient_bits_;
+}
+
+CLASS_METHOD_IMPL(merge, void)
+(const quotient_filter& other) {
+    if (hash_->seed() != other.hash_->seed()) {
+        throw std::invalid_argument("Quotient filters with different hash seeds can not be merged.");
+    }
+    std::size_t quotient_bits = std::max(quotient_bits_, other.quotient_bits_);
+    std::size_t count = table_.size() + other.table_.size();
+    while (count > k_max_load_factor_ * (std::size_t(1) << quotient_bits) && quotient_bits + 1 < F) {
+        ++quotient_bits;
+    }
+    std::size_t remainder_bits = F - quotient_bits;
+    table_type merged(std::size_t(1) << quotient_bits);
+
+    typedef typename table_type::const_iterator table_iterator;
+    auto to_fingerprint = [](const table_iterator& it, std::size_t table_quotient_bits) {
+        auto key_value = *it;
+        return static_cast<S>((S(key_value.first) << (F - table_quotient_bits)) | key_value.second);
+    };
+    table_iterator first = table_.begin(), first_end = table_.end();
+    table_iterator second = other.table_.begin(), second_end = other.table_.end();
+    S first_fp = first != first_end ? to_fingerprint(first, quotient_bits_) : 0;
+    S second_fp = second != second_end ? to_fingerprint(second, other.quotient_bits_) : 0;
+    while (first != first_end || second != second_end) {
+        S fp;
+        if (second == second_end || (first != first_end && first_fp <= second_fp)) {
+            fp = first_fp;
+            if (++first != first_end) {
+                first_fp = to_fingerprint(first, quotient_bits_);
+            }
+        } else {
+            fp = second_fp;
+            if (++second != second_end) {
+                second_fp = to_fingerprint(second, other.quotient_bits_);
+            }
+        }
+        merged.push_back(fp >> remainder_bits, fp & bitmask(remainder_bits));
+    }
+    table_ = std::move(merged);
+    quotient_bits_ = quotient_bits;
+}
+
+CLASS_METHOD_IMPL(save, void)
+(std::ostream& out) const {
+    serialized_header saved = header();
+    write_bytes(out, &saved, sizeof(saved));
+    table_.save(out);
+}
+
+CLASS_METHOD_IMPL(load, quotient_filter<F, Q, HF, T, S, P>)
+(std::istream& in, float max_load_factor) {
+    serialized_header saved = read_header(in);
+    quotient_filter filter = restore(saved, max_load_factor);
+    filter.table_ = table_type(std::size_t(1) << filter.quotient_bits_);
+    filter.table_.load(in, saved.count);
+    return filter;
+}
+
+CLASS_METHOD_IMPL(open, quotient_filter<F, Q, HF, T, S, P>)
+(const std::string& path, float max_load_factor) {
+    auto file = std::make_shared<mapped_file>(path);
+    serialized_header saved = read_header(file->data(), file->size());
+    quotient_filter filter = restore(saved, max_load_factor);
+    std::size_t size = std::size_t(1) << filter.quotient_bits_;
+    if (file->size() < sizeof(saved) + table_type::memory_size(size)) {
+        throw invalid_format_exception("truncated input");
+    }
+    file->advise_random();
+    filter.table_ = table_type(size, static_cast<uint8_t*>(file->data()) + sizeof(saved), saved.count);
+    filter.file_ = std::move(file);
+    return filter;
+}
+
+CLASS_METHOD_IMPL(header, serialized_header)
+() const {
+    serialized_header saved("quotient_filter", hash_factory_->family(), sizeof(S) * 8);
+    saved.seeds[0] = hash_->seed();
+    saved.geometry[0] = F;
+    saved.geometry[1] = Q;
+    saved.geometry[2] = P;
+    saved.shape[0] = quotient_bits_;
+    saved.count = table_.size();
+    return saved;
+}
+
+CLASS_METHOD_IMPL(restore, quotient_filter<F, Q, HF, T, S, P>)
+(const serialized_header& saved, float max_load_factor) {
+    quotient_filter filter(max_load_factor, static_cast<S>(saved.seeds[0]));
+    filter.header().check(saved);
+    if (saved.shape[0] < Q || saved.shape[0] >= F) {
+        throw invalid_format_exception("geometry does not match");
+    }
+    filter.quotient_bits_ = saved.shape[0];
+    return filter;
 }
 
 #undef CLASS_METHOD_IMPL
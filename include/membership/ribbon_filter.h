@@ -0,0 +1,378 @@
+#ifndef INCLUDE_MEMBERSHIP_RIBBON_FILTER_H_
+#define INCLUDE_MEMBERSHIP_RIBBON_FILTER_H_
+
+#include <exception/not_supported.h>
+#include <hash/mmh3_hash_factory.h>
+#include <utils/bits.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "membership.h"
+#include "ribbon_filter_calculator.h"
+
+namespace pdstl {
+
+/*! \brief Ribbon Filter
+ *
+ * ribbon_filter class implements standard ribbon filter (Dillinger and Walzer, "Ribbon filter:
+ * practically smaller than Bloom and Xor") for solving membership problem on static sets.
+ *
+ * Each item has a start slot, 128 random coefficients and an R-bit result. The filter stores a
+ * solution of R bits per slot such that, for every item, the xor of the solutions of the slots
+ * selected by its coefficients, from its start slot on, is its result. Coefficients of all items
+ * form a band of width 128 around the diagonal of the linear system, which is solved by
+ * Gaussian elimination on the fly while items are added, each row being reduced against the
+ * rows stored before it, and then by back substitution. A lookup recomputes the xor and
+ * compares it with the result of the item, a non-member matches with probability 2^-R.
+ *
+ * The filter takes R bits per slot and a few percent more slots than items, see
+ * ribbon_filter_calculator, against 1.44 * R bits per item for a bloom filter with the same
+ * false positive rate. When the system has no solution, which happens for some seeds, the items
+ * are banded again with another seed, and with more slots after a few attempts.
+ *
+ * Solutions are kept as R-bit fields of consecutive slots, so a lookup reads the fields of about
+ * 64 slots. With \a IL set, they are interleaved column-major instead: each block of 64 slots
+ * keeps R words holding one bit of all its slots, so a lookup computes each result bit from two
+ * shifted words and a popcount, reading 3 * R words of consecutive blocks.
+ *
+ * Items can not be inserted or erased after construction, insert and erase throw
+ * not_supported_exception.
+ *
+ * \tparam R - Number of result bits of each item, in [1, 16]
+ * \tparam IL - Interleaved column-major storage of solutions (default: false)
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into ribbon filter (default: std::string)
+ */
+template <
+    std::size_t R,
+    bool IL = false,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string>
+class ribbon_filter : public membership<T> {
+   protected:
+    static constexpr std::size_t k_band_width = ribbon_filter_calculator::k_band_width;
+    static constexpr std::size_t k_block_slots = 64;
+    static constexpr std::size_t k_attempts_per_size = 4;
+    static constexpr std::size_t k_max_attempts = 64;
+
+    //! Coefficients of an item, bit i of \a low (i < 64) or \a high (i >= 64) is the coefficient of start slot + i
+    struct row {
+        uint64_t low;
+        uint64_t high;
+    };
+
+    std::unique_ptr<HF<T, uint64_t>> hash_factory_;
+    std::unique_ptr<hash<T, uint64_t>> hash_;
+    uint64_t seed_;
+    std::size_t num_slots_;
+    std::size_t num_items_;
+    std::vector<uint64_t> solution_;
+
+    //! Hash of an item hash for the current construction attempt (murmur3 finalizer)
+    static inline uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    //! Start slot, coefficients and result of the item with hash \a hash_value
+    inline void locate(uint64_t hash_value, std::size_t& start, row& coefficients, uint16_t& result) const {
+        uint64_t h = mix(hash_value + seed_);
+        start = static_cast<std::size_t>(multiply_high(h, num_slots_ - k_band_width + 1));
+        coefficients.low = mix(h ^ 0x9E3779B97F4A7C15ULL) | 1;
+        coefficients.high = mix(h ^ 0xC2B2AE3D27D4EB4FULL);
+        result = static_cast<uint16_t>(h & bitmask(R));
+    }
+
+    //! Parity of the bits of \a word
+    static inline uint64_t parity(uint64_t word) { return popcount(word) & 1; }
+
+    //! Solution of \a slot
+    uint16_t get_solution(std::size_t slot) const;
+
+    //! Sets the solution of \a slot, which must be zero
+    void set_solution(std::size_t slot, uint16_t value);
+
+    //! Xor of the solutions selected by \a coefficients from slot \a start on
+    uint16_t solution_xor(std::size_t start, const row& coefficients) const;
+
+    //! Sets the number of slots to \a num_slots and zeroes the solutions
+    void allocate(std::size_t num_slots);
+
+    //! Bands the items of \a hashes with the current seed and solves the system, returns false if it has no solution
+    bool solve(const std::vector<uint64_t>& hashes);
+
+   public:
+    //! Default constructor, a filter of the empty set
+    ribbon_filter();
+
+    /*! \brief Constructs a filter of a range of items
+     *
+     * Items are hashed once, repeated items are stored once. The number of slots is given by
+     * ribbon_filter_calculator::number_of_slots for the number of distinct items.
+     * Throws std::runtime_error if no solution is found, which should never happen.
+     *
+     * \param first - iterator to the first item.
+     * \param last - iterator past the last item.
+     */
+    template <typename I>
+    ribbon_filter(I first, I last);
+
+    /*! \brief Insert is not supported in ribbon filter. will throw an exception
+     *
+     * \param item - the item to insert into the filter.
+     */
+    void insert(const T& item) override;
+
+    /*! \brief Erase is not supported in ribbon filter. will throw an exception
+     *
+     * \param item - the item to erase from filter.
+     */
+    void erase(const T& item) override;
+
+    //! \brief Clear filter, leaving a filter of the empty set.
+    void clear() override;
+
+    /*! \brief Check the item and report that it's in the filter or not.
+     *
+     * \param item - the item to check for existence.
+     *
+     * \return false if the item is not in the filter, true if item may be in the filter.
+     */
+    bool contains(const T& item) const override;
+
+    //! \brief Number of distinct items of the filter.
+    std::size_t size() const { return num_items_; }
+
+    //! \brief Number of slots of the filter.
+    std::size_t capacity() const { return num_slots_; }
+
+    //! \brief Memory bits of the solutions.
+    std::size_t memory_bits() const { return num_slots_ * R; }
+};
+
+template <std::size_t R, bool IL, template <typename...> class HF, typename T>
+constexpr std::size_t ribbon_filter<R, IL, HF, T>::k_band_width;
+
+template <std::size_t R, bool IL, template <typename...> class HF, typename T>
+constexpr std::size_t ribbon_filter<R, IL, HF, T>::k_block_slots;
+
+template <std::size_t R, bool IL, template <typename...> class HF, typename T>
+constexpr std::size_t ribbon_filter<R, IL, HF, T>::k_attempts_per_size;
+
+template <std::size_t R, bool IL, template <typename...> class HF, typename T>
+constexpr std::size_t ribbon_filter<R, IL, HF, T>::k_max_attempts;
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t R,                      \
+        bool IL,                            \
+        template <typename...> class HF,    \
+        typename T>                         \
+    __VA_ARGS__ ribbon_filter<R, IL, HF, T>::method_name
+
+CLASS_METHOD_IMPL(ribbon_filter, )
+() : hash_factory_(std::make_unique<HF<T, uint64_t>>()), seed_(0), num_items_(0) {
+    static_assert(R > 0 && R <= 16, "Result bits must be in [1, 16]");
+    hash_ = hash_factory_->create_hash();
+    allocate(ribbon_filter_calculator::number_of_slots(0));
+}
+
+template <std::size_t R, bool IL, template <typename...> class HF, typename T>
+template <typename I>
+ribbon_filter<R, IL, HF, T>::ribbon_filter(I first, I last) : ribbon_filter() {
+    std::vector<uint64_t> hashes;
+    hashes.reserve(std::distance(first, last));
+    for (; first != last; ++first) {
+        hashes.push_back(hash_->value(*first));
+    }
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    std::size_t num_slots = ribbon_filter_calculator::number_of_slots(hashes.size());
+    for (std::size_t attempt = 1;; ++attempt, seed_ += 0x9E3779B97F4A7C15ULL) {
+        allocate(num_slots);
+        if (solve(hashes)) {
+            break;
+        }
+        if (attempt == k_max_attempts) {
+            throw std::runtime_error("Ribbon filter construction failed.");
+        }
+        if (attempt % k_attempts_per_size == 0) {
+            num_slots += (hashes.size() / 100 + k_block_slots - 1) / k_block_slots * k_block_slots;
+        }
+    }
+    num_items_ = hashes.size();
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& /* item */) {
+    throw not_supported_exception();
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(const T& /* item */) {
+    throw not_supported_exception();
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    allocate(ribbon_filter_calculator::number_of_slots(0));
+    num_items_ = 0;
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(const T& item) const {
+    // solutions of an empty filter are all zero and would match 2^-R of the items
+    if (num_items_ == 0) {
+        return false;
+    }
+    std::size_t start;
+    row coefficients;
+    uint16_t result;
+    locate(hash_->value(item), start, coefficients, result);
+    return solution_xor(start, coefficients) == result;
+}
+
+CLASS_METHOD_IMPL(allocate, void)
+(std::size_t num_slots) {
+    num_slots_ = num_slots;
+    // one more block, so interleaved lookups may read the block after the last one
+    solution_.assign((num_slots / k_block_slots + 1) * R, 0);
+}
+
+CLASS_METHOD_IMPL(get_solution, uint16_t)
+(std::size_t slot) const {
+    if (IL) {
+        const uint64_t* words = &solution_[slot / k_block_slots * R];
+        uint16_t value = 0;
+        for (std::size_t bit = 0; bit < R; ++bit) {
+            value = static_cast<uint16_t>(value | (((words[bit] >> (slot % k_block_slots)) & 1) << bit));
+        }
+        return value;
+    }
+    std::size_t bit = slot * R;
+    std::size_t shift = bit % 64;
+    uint64_t value = solution_[bit / 64] >> shift;
+    if (shift + R > 64) {
+        value |= solution_[bit / 64 + 1] << (64 - shift);
+    }
+    return static_cast<uint16_t>(value & bitmask(R));
+}
+
+CLASS_METHOD_IMPL(set_solution, void)
+(std::size_t slot, uint16_t value) {
+    if (IL) {
+        uint64_t* words = &solution_[slot / k_block_slots * R];
+        for (std::size_t bit = 0; bit < R; ++bit) {
+            words[bit] |= uint64_t((value >> bit) & 1) << (slot % k_block_slots);
+        }
+        return;
+    }
+    std::size_t bit = slot * R;
+    std::size_t shift = bit % 64;
+    solution_[bit / 64] |= uint64_t(value) << shift;
+    if (shift + R > 64) {
+        solution_[bit / 64 + 1] |= uint64_t(value) >> (64 - shift);
+    }
+}
+
+CLASS_METHOD_IMPL(solution_xor, uint16_t)
+(std::size_t start, const row& coefficients) const {
+    uint16_t value = 0;
+    if (IL) {
+        const uint64_t* words = &solution_[start / k_block_slots * R];
+        std::size_t shift = start % k_block_slots;
+        for (std::size_t bit = 0; bit < R; ++bit) {
+            uint64_t low = words[bit] >> shift;
+            uint64_t high = words[R + bit] >> shift;
+            if (shift > 0) {
+                low |= words[R + bit] << (64 - shift);
+                high |= words[2 * R + bit] << (64 - shift);
+            }
+            value = static_cast<uint16_t>(value | (parity((low & coefficients.low) ^ (high & coefficients.high)) << bit));
+        }
+        return value;
+    }
+    for (uint64_t word = coefficients.low; word; word &= word - 1) {
+        value ^= get_solution(start + count_trailing_zeros(word));
+    }
+    for (uint64_t word = coefficients.high; word; word &= word - 1) {
+        value ^= get_solution(start + 64 + count_trailing_zeros(word));
+    }
+    return value;
+}
+
+CLASS_METHOD_IMPL(solve, bool)
+(const std::vector<uint64_t>& hashes) {
+    // banding: row i keeps the reduced equation whose leading coefficient is slot i, if any
+    std::vector<row> rows(num_slots_, row{0, 0});
+    std::vector<uint16_t> results(num_slots_, 0);
+    for (uint64_t hash_value : hashes) {
+        std::size_t slot;
+        row coefficients;
+        uint16_t result;
+        locate(hash_value, slot, coefficients, result);
+        while (true) {
+            row& pivot = rows[slot];
+            if (pivot.low == 0 && pivot.high == 0) {
+                pivot = coefficients;
+                results[slot] = result;
+                break;
+            }
+            coefficients.low ^= pivot.low;
+            coefficients.high ^= pivot.high;
+            result ^= results[slot];
+            if (coefficients.low == 0 && coefficients.high == 0) {
+                // a repeated item reduces to 0 = 0, any other equation to 0 = result has no solution
+                if (result != 0) {
+                    return false;
+                }
+                break;
+            }
+            std::size_t shift = coefficients.low ? count_trailing_zeros(coefficients.low) : 64 + count_trailing_zeros(coefficients.high);
+            slot += shift;
+            if (shift >= 64) {
+                coefficients.low = coefficients.high >> (shift - 64);
+                coefficients.high = 0;
+            } else {
+                coefficients.low = (coefficients.low >> shift) | (shift ? coefficients.high << (64 - shift) : 0);
+                coefficients.high >>= shift;
+            }
+        }
+    }
+
+    // back substitution, keeping the solution bits of the next 128 slots of each result bit, free slots get 0
+    uint64_t window_low[R] = {};
+    uint64_t window_high[R] = {};
+    for (std::size_t slot = num_slots_; slot-- > 0;) {
+        const row& pivot = rows[slot];
+        uint16_t value = 0;
+        for (std::size_t bit = 0; bit < R; ++bit) {
+            window_high[bit] = (window_high[bit] << 1) | (window_low[bit] >> 63);
+            window_low[bit] <<= 1;
+            uint64_t solution_bit = 0;
+            if (pivot.low != 0 || pivot.high != 0) {
+                solution_bit = parity((window_low[bit] & pivot.low) ^ (window_high[bit] & pivot.high)) ^ ((results[slot] >> bit) & 1);
+            }
+            window_low[bit] |= solution_bit;
+            value = static_cast<uint16_t>(value | (solution_bit << bit));
+        }
+        set_solution(slot, value);
+    }
+    return true;
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_MEMBERSHIP_RIBBON_FILTER_H_
@@ -0,0 +1,86 @@
+#ifndef INCLUDE_MEMBERSHIP_RIBBON_FILTER_CALCULATOR_H_
+#define INCLUDE_MEMBERSHIP_RIBBON_FILTER_CALCULATOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace pdstl {
+
+/*! \brief Ribbon Filter Calculator
+ *
+ *  ribbon_filter_calculator calculates number of result bits, number of slots and false positive probability of ribbon filters.
+ */
+class ribbon_filter_calculator {
+   public:
+    //! Number of coefficients of each item, the width of the band of the linear system
+    static constexpr std::size_t k_band_width = 128;
+
+    /*! \brief compute the fraction of extra slots needed to build a ribbon filter
+     *
+     * The band of a standard ribbon filter needs more extra slots for larger sets, about 3% for
+     * 10^4 items and 5% for 10^6 items, with which construction succeeds for most seeds.
+     *
+     * \param expected_number_of_elements - [in] Expected number of elements will be inserted into ribbon filter.
+     *
+     * \return fraction of slots above the number of elements.
+     */
+    static double slot_overhead(std::size_t expected_number_of_elements) {
+        if (expected_number_of_elements <= 1000) {
+            return 0.01;
+        }
+        return 0.01 * std::log10(expected_number_of_elements) - 0.01;
+    }
+
+    /*! \brief compute the number of slots of a ribbon filter
+     *
+     * \param expected_number_of_elements - [in] Expected number of elements will be inserted into ribbon filter.
+     *
+     * \return number of slots, a multiple of 64.
+     */
+    static std::size_t number_of_slots(std::size_t expected_number_of_elements) {
+        std::size_t slots = static_cast<std::size_t>(std::ceil(expected_number_of_elements * (1 + slot_overhead(expected_number_of_elements)))) + k_band_width;
+        return (slots + 63) / 64 * 64;
+    }
+
+    /*! \brief compute parameters for ribbon filter
+     * \param expected_number_of_elements -  [in] Expected number of elements will be inserted into ribbon filter.
+     * \param false_positive_probability - [in] Desiered false-positive probability
+     * \param number_of_result_bits - [out] number of result bits of each slot, in [1, 16].
+     * \param number_of_slots - [out] number of slots.
+     */
+    static void optimal_params(
+        std::size_t expected_number_of_elements, float false_positive_probability,
+        std::size_t& number_of_result_bits, std::size_t& number_of_slots) {
+        double bits = std::ceil(-std::log2(false_positive_probability));
+        number_of_result_bits = static_cast<std::size_t>(std::min(16.0, std::max(1.0, bits)));
+        number_of_slots = ribbon_filter_calculator::number_of_slots(expected_number_of_elements);
+    }
+
+    /*! \brief compute false-positive porbability of ribbon filter
+     *
+     * \param number_of_result_bits - [in] number of result bits of each slot.
+     *
+     * \return false-positive porbability of ribbon filter
+     */
+    static float false_positive_probability(std::size_t number_of_result_bits) {
+        return std::ldexp(1.0f, -static_cast<int>(number_of_result_bits));
+    }
+
+    /*! \brief compute memory bits per element of ribbon filter
+     *
+     * The information-theoretic minimum is number_of_result_bits bits per element.
+     *
+     * \param expected_number_of_elements -  [in] Expected number of elements will be inserted into ribbon filter.
+     * \param number_of_result_bits - [in] number of result bits of each slot.
+     *
+     * \return memory bits per element
+     */
+    static double bits_per_element(std::size_t expected_number_of_elements, std::size_t number_of_result_bits) {
+        return double(number_of_slots(expected_number_of_elements)) * number_of_result_bits / std::max<std::size_t>(1, expected_number_of_elements);
+    }
+};
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_MEMBERSHIP_RIBBON_FILTER_CALCULATOR_H_
@@ -0,0 +1,283 @@
+#ifndef INCLUDE_TABLE_CONCURRENT_QUOTIENT_TABLE_H_
+#define INCLUDE_TABLE_CONCURRENT_QUOTIENT_TABLE_H_
+
+#include <utils/bits.h>
+#include <utils/spin_lock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "quotient_table.h"
+
+namespace pdstl {
+
+/*! \brief Concurrent Quotient Table
+ *
+ * concurrent_quotient_table class is a quotient table which can be used by several threads at
+ * the same time (Pandey et al., "A General-Purpose Counting Filter: Making Every Bit Count").
+ *
+ * Slots are partitioned into regions of 4096 slots, each guarded by a spin lock. An operation on
+ * a key locks the region holding the slot before the key and the next region. Before touching
+ * the table, it checks that all the slots it reads or shifts (the cluster of the key up to its
+ * first unused slot, and the blocks read to resolve saturated offsets) are inside the locked
+ * regions. Operations on long clusters release their locks and retry with a wider window of
+ * regions, always locking in ascending order, so threads never deadlock.
+ *
+ * insert, erase and contains are thread-safe, clear is not.
+ *
+ * \tparam T - Type of value
+ * \tparam E - Number of bits used for each value (default: sizeof(T) * 8 -3)
+ * \tparam P - Pack values into E-bit fields (default: false)
+ * \tparam M - Keep repeated key-values, once per insert, see quotient_table (default: false)
+ */
+template <typename T, std::size_t E = sizeof(T) * 8 - 3, bool P = false, bool M = false>
+class concurrent_quotient_table : protected quotient_table<T, E, P, M> {
+   protected:
+    typedef quotient_table<T, E, P, M> base;
+    using base::blocks_;
+    using base::k_block_slots;
+    using base::k_saturated_offset;
+    using base::num_blocks_;
+    using base::offsets_;
+
+    static constexpr size_t k_region_slots = 4096;
+
+    //! Locks regions [first, last] in ascending order and unlocks them on destruction
+    class region_guard {
+       private:
+        const concurrent_quotient_table& table_;
+        size_t first_;
+        size_t last_;
+
+       public:
+        region_guard(const concurrent_quotient_table& table, size_t first, size_t last) : table_(table), first_(first), last_(last) {
+            for (size_t region = first_; region <= last_; ++region) {
+                table_.locks_[region].lock();
+            }
+        }
+        ~region_guard() {
+            for (size_t region = first_; region <= last_; ++region) {
+                table_.locks_[region].unlock();
+            }
+        }
+        region_guard(const region_guard&) = delete;
+        region_guard& operator=(const region_guard&) = delete;
+
+        //! Whether an operation on \a key reads and writes only slots of the locked regions
+        bool covers(size_t key) const {
+            size_t limit = std::min((last_ + 1) * k_region_slots, table_.num_blocks_ * k_block_slots);
+            return (first_ == 0 && last_ == table_.num_regions_ - 1) || table_.fits(key, first_ * k_region_slots, limit);
+        }
+    };
+
+    size_t num_regions_;
+    std::unique_ptr<spin_lock[]> locks_;
+    std::atomic<size_t> num_values_;
+
+    //! First region locked for an operation on \a key, the one holding the block before \a key
+    static size_t home_region(size_t key) { return key == 0 ? 0 : (key - 1) / k_region_slots; }
+
+    /*! \brief Bounded counterpart of run_tail, fails if it reads a block outside [lo, limit).
+     *
+     * \return true and the tail in \a tail on success, false otherwise.
+     */
+    bool bounded_run_tail(size_t slot, size_t lo, size_t limit, size_t& tail) const;
+
+    //! Whether an operation on \a key only reads and writes slots in [lo, limit)
+    bool fits(size_t key, size_t lo, size_t limit) const;
+
+    //! Runs \a operation with the regions holding every slot it reads or writes locked
+    template <typename O>
+    auto locked(size_t key, O operation) const -> decltype(operation());
+
+   public:
+    /*! \brief Default constructor
+     *
+     * \param size - Number of keys in the table
+     */
+    explicit concurrent_quotient_table(size_t size);
+
+    /*! \brief insert a key-value in the table
+     *
+     * Throws capacity_exceeded_exception if there is no unused slot left for the value.
+     *
+     * \param key - the key to insert into the table.
+     * \param value - the value to insert into the table
+     */
+    void insert(size_t key, T value);
+
+    /*! \brief insert key-values sorted in ascending (key, value) order.
+     *
+     * Consecutive key-values falling in the same regions are inserted while holding their locks
+     * once, which cuts lock traffic and keeps the touched blocks in cache.
+     * Throws capacity_exceeded_exception if there is no unused slot left for a value, values
+     * before it are inserted.
+     *
+     * \param first - iterator to the first std::pair<size_t, T> key-value.
+     * \param last - iterator past the last key-value.
+     */
+    template <typename I>
+    void insert(I first, I last);
+
+    /*! \brief Erase a key-value from the table.
+     *
+     * Erasing a key-value which is not in the table does nothing.
+     *
+     * \param key - the key to erase from table.
+     * \param value - the value to erase from table.
+     */
+    void erase(size_t key, T value);
+
+    /*! \brief Check the table for key-value existence.
+     *
+     * \param key - the key to check.
+     * \param value - the value to check.
+     *
+     * \return true if the key-value is in the table, false otherwise.
+     */
+    bool contains(size_t key, T value) const;
+
+    //! \brief Clear table and resets its internal memory, must not run along other operations.
+    void clear() {
+        base::clear();
+        num_values_ = 0;
+    }
+
+    //! \brief Number of key-values in the table.
+    size_t size() const { return num_values_.load(std::memory_order_relaxed); }
+
+    //! \brief Number of keys of the table.
+    using base::capacity;
+};
+
+template <typename T, std::size_t E, bool P, bool M>
+constexpr size_t concurrent_quotient_table<T, E, P, M>::k_region_slots;
+
+#define CLASS_METHOD_IMPL(method_name, ...)              \
+    template <typename T, std::size_t E, bool P, bool M> \
+    __VA_ARGS__ concurrent_quotient_table<T, E, P, M>::method_name
+
+CLASS_METHOD_IMPL(concurrent_quotient_table, )
+(size_t size) : base(size),
+                num_regions_((num_blocks_ * k_block_slots + k_region_slots - 1) / k_region_slots),
+                locks_(new spin_lock[num_regions_]),
+                num_values_(0) {
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(size_t key, T value) {
+    if (locked(key, [this, key, value]() { return this->insert_value(key, value); })) {
+        num_values_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, std::size_t E, bool P, bool M>
+template <typename I>
+void concurrent_quotient_table<T, E, P, M>::insert(I first, I last) {
+    while (first != last) {
+        size_t region = home_region(first->first);
+        size_t inserted = 0;
+        {
+            region_guard guard(*this, region, std::min(region + 1, num_regions_ - 1));
+            for (; first != last && guard.covers(first->first); ++first) {
+                inserted += this->insert_value(first->first, first->second) ? 1 : 0;
+            }
+        }
+        num_values_.fetch_add(inserted, std::memory_order_relaxed);
+        if (first != last && home_region(first->first) == region) {
+            // the cluster of this key leaves the regions, take the wider window
+            insert(first->first, first->second);
+            ++first;
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(size_t key, T value) {
+    if (locked(key, [this, key, value]() { return this->erase_value(key, value); })) {
+        num_values_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(size_t key, T value) const {
+    return locked(key, [this, key, value]() { return this->base::contains(key, value); });
+}
+
+template <typename T, std::size_t E, bool P, bool M>
+template <typename O>
+auto concurrent_quotient_table<T, E, P, M>::locked(size_t key, O operation) const -> decltype(operation()) {
+    size_t region = home_region(key);
+    for (size_t width = 0;; width = 2 * width + 1) {
+        region_guard guard(*this, region > width ? region - width : 0, std::min(region + 1 + width, num_regions_ - 1));
+        if (guard.covers(key)) {
+            return operation();
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(bounded_run_tail, bool)
+(size_t slot, size_t lo, size_t limit, size_t& tail) const {
+    size_t block_index = slot / k_block_slots;
+    size_t block_start = block_index * k_block_slots;
+    if (block_start < lo || block_start >= limit) {
+        return false;
+    }
+    size_t offset = offsets_[block_index];
+    if (offset == k_saturated_offset) {
+        if (block_start == lo || !bounded_run_tail(block_start - 1, lo, limit, offset)) {
+            return false;
+        }
+        offset = offset > block_start ? offset - block_start : 0;
+    }
+    size_t rank = popcount(blocks_[block_index].occupieds & bitmask(slot - block_start + 1));
+    if (rank == 0) {
+        tail = block_start + offset;
+        return true;
+    }
+    // select the (rank - 1)-th runend at or after block_start + offset without leaving [lo, limit)
+    --rank;
+    size_t position = block_start + offset;
+    block_index = position / k_block_slots;
+    if (block_index * k_block_slots >= limit) {
+        return false;
+    }
+    uint64_t word = blocks_[block_index].runends & ~bitmask(position % k_block_slots);
+    while (true) {
+        size_t word_count = popcount(word);
+        if (rank < word_count) {
+            tail = block_index * k_block_slots + select_bit(word, rank) + 1;
+            return true;
+        }
+        rank -= word_count;
+        if (++block_index * k_block_slots >= limit) {
+            return false;
+        }
+        word = blocks_[block_index].runends;
+    }
+}
+
+CLASS_METHOD_IMPL(fits, bool)
+(size_t key, size_t lo, size_t limit) const {
+    size_t tail;
+    if (key > 0 && !bounded_run_tail(key - 1, lo, limit, tail)) {
+        return false;
+    }
+    // every slot read or shifted lies before the first unused slot at or after key
+    for (size_t slot = key; slot < limit; slot = tail) {
+        if (!bounded_run_tail(slot, lo, limit, tail)) {
+            return false;
+        }
+        if (tail <= slot) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_TABLE_CONCURRENT_QUOTIENT_TABLE_H_
@@ -0,0 +1,339 @@
+#ifndef INCLUDE_TABLE_COUNTING_QUOTIENT_TABLE_H_
+#define INCLUDE_TABLE_COUNTING_QUOTIENT_TABLE_H_
+
+#include <utils/bits.h>
+
+#include <cstdint>
+
+#include "quotient_table.h"
+
+namespace pdstl {
+
+/*! \brief Counting Quotient Table
+ *
+ * counting_quotient_table class implements a quotient table which keeps a count for each
+ * key-value (Pandey et al., "A General-Purpose Counting Filter: Making Every Bit Count").
+ *
+ * Counts are encoded inline in the run of the key, right after the value, using the slots as
+ * variable-length counters. A key-value with count 1 uses one slot, a count of 2 uses two slots
+ * and larger counts use O(log(count) / E) slots. Counter digits are never equal to the value they
+ * follow, so the value after a counter tells where the counter ends.
+ *
+ * \tparam T - Slot type of the table
+ * \tparam E - Number of bits of each slot, must be at least 2 (default: sizeof(T) * 8 - 3)
+ * \tparam P - Pack slots of E bits in blocks instead of storing one T per slot (default: false)
+ */
+template <typename T, std::size_t E = sizeof(T) * 8 - 3, bool P = false>
+class counting_quotient_table : protected quotient_table<T, E, P> {
+   protected:
+    typedef quotient_table<T, E, P> base;
+    using base::count_;
+    using base::get_value;
+    using base::is_occupied;
+    using base::is_runend;
+    using base::next_occupied;
+    using base::run_start;
+    using base::run_tail;
+    using base::size_;
+
+    //! Most slots used by one key-value: the value, a padding slot, 64 digits and two terminators
+    static constexpr size_t k_max_entry_slots = 68;
+
+    /*! \brief Encodes a key-value with \a count into slots.
+     *
+     * \return number of slots written into \a slots, 0 if \a count is 0.
+     */
+    size_t encode(T value, uint64_t count, T* slots) const;
+
+    /*! \brief Decodes the key-value starting at \a slot of a run ending before \a end.
+     *
+     * \return position just after the key-value.
+     */
+    size_t decode(size_t slot, size_t end, T& value, uint64_t& count) const;
+
+    //! Replaces slots [first, last) of the run of \a key by \a value with \a count
+    void replace(size_t key, size_t first, size_t last, T value, uint64_t count);
+
+   public:
+    /*! \brief Default constructor
+     *
+     * \param size - Number of keys in the table
+     */
+    explicit counting_quotient_table(size_t size);
+
+    /*! \brief Add \a count to the count of a key-value.
+     *
+     * Throws capacity_exceeded_exception if there is no unused slot left for the counter, in which
+     * case the table is left unchanged.
+     *
+     * \param key - the key to insert into the table.
+     * \param value - the value to insert into the table.
+     * \param count - the count to add (default: 1)
+     */
+    void insert(size_t key, T value, uint64_t count = 1);
+
+    /*! \brief Subtract \a count from the count of a key-value.
+     *
+     * The key-value is removed once its count drops to 0. Erasing a key-value which is not in the
+     * table does nothing.
+     *
+     * \param key - the key to erase from table.
+     * \param value - the value to erase from table.
+     * \param count - the count to subtract (default: 1)
+     */
+    void erase(size_t key, T value, uint64_t count = 1);
+
+    /*! \brief Count of a key-value.
+     *
+     * \param key - the key to look up.
+     * \param value - the value to look up.
+     *
+     * \return number of times the key-value is inserted and not erased.
+     */
+    uint64_t count(size_t key, T value) const;
+
+    /*! \biref Check the table for key-value existence.
+     *
+     * \param key - the key to insert into the table.
+     * \param value - the value to insert into the table
+     *
+     * \return true if the key-value is in the table, false otherwise.
+     */
+    bool contains(size_t key, T value) const { return count(key, value) > 0; }
+
+    /*! \brief Visit all key-values of the table in ascending (key, value) order.
+     *
+     * \param visitor - callable invoked as visitor(key, value, count) for each key-value.
+     */
+    template <typename V>
+    void for_each(V visitor) const;
+
+    using base::clear;
+
+    //! \brief Number of slots in use.
+    using base::size;
+
+    //! \brief Number of keys of the table.
+    using base::capacity;
+};
+
+template <typename T, std::size_t E, bool P>
+constexpr size_t counting_quotient_table<T, E, P>::k_max_entry_slots;
+
+#define CLASS_METHOD_IMPL(method_name, ...)      \
+    template <typename T, std::size_t E, bool P> \
+    __VA_ARGS__ counting_quotient_table<T, E, P>::method_name
+
+CLASS_METHOD_IMPL(counting_quotient_table, )
+(size_t size) : base(size) {
+    static_assert(E >= 2, "Counters need slots of at least 2 bits");
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(size_t key, T value, uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+    size_t slot = run_start(key);
+    if (is_occupied(key)) {
+        size_t end = run_tail(key);
+        while (slot < end) {
+            T slot_value;
+            uint64_t slot_count;
+            size_t next = decode(slot, end, slot_value, slot_count);
+            if (slot_value == value) {
+                replace(key, slot, next, value, slot_count + count);
+                return;
+            }
+            if (slot_value > value) {
+                break;
+            }
+            slot = next;
+        }
+    }
+    replace(key, slot, slot, value, count);
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(size_t key, T value, uint64_t count) {
+    if (!is_occupied(key)) {
+        return;
+    }
+    size_t end = run_tail(key);
+    for (size_t slot = run_start(key); slot < end;) {
+        T slot_value;
+        uint64_t slot_count;
+        size_t next = decode(slot, end, slot_value, slot_count);
+        if (slot_value == value) {
+            replace(key, slot, next, value, slot_count > count ? slot_count - count : 0);
+            return;
+        }
+        if (slot_value > value) {
+            return;
+        }
+        slot = next;
+    }
+}
+
+CLASS_METHOD_IMPL(count, uint64_t)
+(size_t key, T value) const {
+    if (!is_occupied(key)) {
+        return 0;
+    }
+    size_t end = run_tail(key);
+    for (size_t slot = run_start(key); slot < end;) {
+        T slot_value;
+        uint64_t slot_count;
+        slot = decode(slot, end, slot_value, slot_count);
+        if (slot_value == value) {
+            return slot_count;
+        }
+        if (slot_value > value) {
+            break;
+        }
+    }
+    return 0;
+}
+
+template <typename T, std::size_t E, bool P>
+template <typename V>
+void counting_quotient_table<T, E, P>::for_each(V visitor) const {
+    size_t slot = 0;
+    for (size_t key = is_occupied(0) ? 0 : next_occupied(0); key < size_; key = next_occupied(key)) {
+        slot = std::max(slot, key);
+        size_t end = this->select_runend(slot, 0) + 1;
+        while (slot < end) {
+            T value;
+            uint64_t count;
+            slot = decode(slot, end, value, count);
+            visitor(key, value, count);
+        }
+    }
+}
+
+CLASS_METHOD_IMPL(replace, void)
+(size_t key, size_t first, size_t last, T value, uint64_t count) {
+    T slots[k_max_entry_slots];
+    size_t length = encode(value, count, slots);
+    // find the unused slots first, so a table without room for the counter is left untouched
+    for (size_t used = last - first, unused = last; used < length; ++used) {
+        unused = this->find_unused(unused) + 1;
+    }
+    for (size_t used = last - first; used < length; ++used) {
+        this->insert_slot(key, last, 0);
+        ++count_;
+    }
+    for (size_t used = last - first; used > length; --used) {
+        this->erase_slot(key, first);
+        --count_;
+    }
+    for (size_t index = 0; index < length; ++index) {
+        this->set_value(first + index, slots[index]);
+    }
+}
+
+CLASS_METHOD_IMPL(encode, size_t)
+(T value, uint64_t count, T* slots) const {
+    if (count == 0) {
+        return 0;
+    }
+    size_t length = 0;
+    slots[length++] = value;
+    if (count == 1) {
+        return length;
+    }
+    if (count == 2) {
+        slots[length++] = value;
+        return length;
+    }
+    if (count == 3) {
+        slots[length++] = 0;
+        slots[length++] = value;
+        return length;
+    }
+    // digits are stored plus one so they are never 0, and skip the value itself when it is not 0
+    uint64_t radix = value == 0 ? bitmask(E) : bitmask(E) - 1;
+    uint64_t rest = count - (value == 0 ? 4 : 3);
+    T digits[64];
+    size_t num_digits = 0;
+    do {
+        uint64_t digit = rest % radix + 1;
+        if (value != 0 && digit >= value) {
+            ++digit;
+        }
+        digits[num_digits++] = static_cast<T>(digit);
+        rest /= radix;
+    } while (rest != 0);
+    // a counter starts with a slot smaller than the value, which is padded with 0 if needed
+    if (value != 0 && digits[num_digits - 1] > value) {
+        slots[length++] = 0;
+    }
+    while (num_digits > 0) {
+        slots[length++] = digits[--num_digits];
+    }
+    slots[length++] = value;
+    if (value == 0) {
+        slots[length++] = 0;
+    }
+    return length;
+}
+
+CLASS_METHOD_IMPL(decode, size_t)
+(size_t slot, size_t end, T& value, uint64_t& count) const {
+    value = get_value(slot);
+    count = 1;
+    if (slot + 1 == end) {
+        return slot + 1;
+    }
+    T next = get_value(slot + 1);
+    if (value != 0) {
+        if (next > value) {
+            return slot + 1;
+        }
+        if (next == value) {
+            count = 2;
+            return slot + 2;
+        }
+        if (next == 0 && get_value(slot + 2) == value) {
+            count = 3;
+            return slot + 3;
+        }
+        uint64_t radix = bitmask(E) - 1;
+        uint64_t rest = 0;
+        size_t digit_slot = next == 0 ? slot + 2 : slot + 1;
+        for (T digit; (digit = get_value(digit_slot)) != value; ++digit_slot) {
+            rest = rest * radix + (digit > value ? digit - 2 : digit - 1);
+        }
+        count = rest + 3;
+        return digit_slot + 1;
+    }
+    if (next == 0) {
+        if (slot + 2 < end && get_value(slot + 2) == 0) {
+            count = 3;
+            return slot + 3;
+        }
+        count = 2;
+        return slot + 2;
+    }
+    // a counter of value 0 is a sequence of non-zero digits terminated by two 0 slots
+    size_t digit_slot = slot + 1;
+    while (digit_slot < end && get_value(digit_slot) != 0) {
+        ++digit_slot;
+    }
+    if (digit_slot + 1 >= end || get_value(digit_slot + 1) != 0) {
+        return slot + 1;
+    }
+    uint64_t radix = bitmask(E);
+    uint64_t rest = 0;
+    for (size_t index = slot + 1; index < digit_slot; ++index) {
+        rest = rest * radix + (get_value(index) - 1);
+    }
+    count = rest + 4;
+    return digit_slot + 2;
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_TABLE_COUNTING_QUOTIENT_TABLE_H_
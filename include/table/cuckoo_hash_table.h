@@ -0,0 +1,343 @@
+#ifndef INCLUDE_TABLE_CUCKOO_HASH_TABLE_H_
+#define INCLUDE_TABLE_CUCKOO_HASH_TABLE_H_
+
+#include <exception/capacity_exceeded.h>
+#include <hash/mmh3_hash_factory.h>
+#include <membership/cuckoo_filter.h>
+#include <utils/aligned_allocator.h>
+#include <utils/bits.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pdstl {
+
+/*! \brief Cuckoo Hash Table
+ *
+ * cuckoo_hash_table class implements a compact map from items to values with partial-key
+ * cuckoo hashing, with the array_bucket layout of cuckoo_filter. Each item has an FB-bit
+ * fingerprint and two candidate buckets of IC slots, the second one derived from the first
+ * and the fingerprint. Each bucket keeps its fingerprints followed by their values, aligned so
+ * that a bucket of at most 64 bytes fits in one cache line, e.g. 32 bytes for four 32-bit
+ * fingerprints and values. A lookup compares the fingerprint against a whole bucket at once
+ * (SWAR) and reads the value from the same cache line. The second bucket is read only if the
+ * first one misses, so a lookup reads at most two cache lines, and one when the item is in its
+ * first bucket.
+ *
+ * Like quotient_hash_table, the table answers for fingerprints, not items: looking up an item
+ * which was not inserted returns the value of an inserted item with the same fingerprint and
+ * one of the same buckets with probability about 2 * IC / 2^FB. When both buckets of an item
+ * are full, the shortest path of entries to move to their alternate buckets is searched
+ * breadth first, which fills 4-slot buckets to about 95% and 8-slot buckets to about 98%.
+ *
+ * \tparam FB - Number of bits of each fingerprint (at most 32)
+ * \tparam IC - Number of slots in each bucket (default: 4)
+ * \tparam V - Value type (default: uint32_t)
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into cuckoo hash table (default: std::string)
+ * \tparam S - Hash output type (default: uint32_t)
+ */
+template <
+    std::size_t FB,
+    std::size_t IC = 4,
+    typename V = uint32_t,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string,
+    typename S = uint32_t>
+class cuckoo_hash_table {
+   protected:
+    static constexpr size_t k_no_parent = ~size_t(0);
+
+    //! Bucket of the eviction search, reached by moving the entry in \a slot of bucket \a parent
+    struct path_node {
+        size_t index;
+        size_t parent;
+        size_t slot;
+    };
+
+    typedef array_bucket<FB, IC> finger_print_bucket;
+
+    static constexpr size_t k_bucket_alignment = cache_line_alignment(
+        sizeof(finger_print_bucket) + IC * sizeof(V), std::max(alignof(finger_print_bucket), alignof(V)));
+
+    //! Fingerprints of a bucket and their values, in one cache line if they fit
+    struct alignas(k_bucket_alignment) value_bucket {
+        finger_print_bucket finger_prints;
+        V values[IC];
+    };
+
+    std::unique_ptr<HF<T, S>> hash_factory_;
+    std::unique_ptr<hash<T, S>> hash_;
+    std::vector<value_bucket, aligned_allocator<value_bucket, k_bucket_alignment>> buckets_;
+    const size_t k_max_kicks_;
+    size_t num_items_;
+
+    //! Non-zero fingerprint from the high bits of \a hash_value, 0 marks empty slots
+    inline S make_finger_print(S hash_value) const {
+        S finger_print = static_cast<S>((hash_value >> (sizeof(S) * 8 - FB)) & bitmask(FB));
+        return finger_print == 0 ? 1 : finger_print;
+    }
+
+    //! The other bucket of \a finger_print, from the high half of a multiplication instead of a second hash function
+    inline size_t alternate_index(size_t index, S finger_print) const {
+        return index ^ (((uint64_t(finger_print) * 0x9E3779B97F4A7C15ULL) >> 32) & (buckets_.size() - 1));
+    }
+
+    //! First bucket \a index and fingerprint \a finger_print of \a item
+    inline void locate(const T& item, size_t& index, S& finger_print) const {
+        S hash_value = hash_->value(item);
+        finger_print = make_finger_print(hash_value);
+        index = hash_value & (buckets_.size() - 1);
+    }
+
+    //! Finds the entry of \a finger_print in bucket \a index or its alternate, returns false if there is none
+    bool find_entry(size_t index, S finger_print, size_t& bucket, size_t& slot) const;
+
+    //! Makes room for the entry in bucket \a i or \a j along the shortest eviction path and stores it
+    bool evict(size_t i, size_t j, S finger_print, const V& value);
+
+   public:
+    /*! \brief Default constructor
+     *
+     * \param num_buckets - number of buckets, rounded up to a power of two
+     * \param max_kicks - maximum number of buckets visited when searching for an eviction path
+     */
+    cuckoo_hash_table(size_t num_buckets, size_t max_kicks);
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * \param num_buckets - number of buckets, rounded up to a power of two
+     * \param max_kicks - maximum number of buckets visited when searching for an eviction path
+     * \param seed - seed of the hash function
+     */
+    cuckoo_hash_table(size_t num_buckets, size_t max_kicks, S seed);
+
+    /*! \brief Insert an item with its value, or replace the value of an item in the table.
+     *
+     * Throws capacity_exceeded_exception if the table is full.
+     *
+     * \param item - the item to insert into the table.
+     * \param value - the value of the item.
+     */
+    void insert(const T& item, const V& value);
+
+    /*! \brief Insert an item with its value, or replace the value of an item in the table.
+     *
+     * \param item - the item to insert into the table.
+     * \param value - the value of the item.
+     *
+     * \return true if the item is inserted, false if the table is full and is left unchanged.
+     */
+    bool try_insert(const T& item, const V& value);
+
+    /*! \brief Look up the value of an item.
+     *
+     * \param item - the item to look up.
+     * \param value - receives the value of the item if it is found.
+     *
+     * \return true if the item (or another item with the same fingerprint) is in the table.
+     */
+    bool find(const T& item, V& value) const;
+
+    /*! \brief Check the item and report that it's in the table or not.
+     *
+     * \param item - the item to check for existence.
+     *
+     * \return false if the item is not in the table, true if item may be in the table.
+     */
+    bool contains(const T& item) const;
+
+    /*! \brief Erase an item with its value from the table.
+     *
+     * Erasing an item which was not inserted may remove another item with the same fingerprint.
+     *
+     * \param item - the item to erase from table.
+     */
+    void erase(const T& item);
+
+    //! \brief Clear table and resets its internal memory.
+    void clear();
+
+    //! \brief Number of items in the table.
+    size_t size() const { return num_items_; }
+
+    //! \brief Number of slots of the table.
+    size_t capacity() const { return buckets_.size() * IC; }
+};
+
+template <std::size_t FB, std::size_t IC, typename V, template <typename...> class HF, typename T, typename S>
+constexpr size_t cuckoo_hash_table<FB, IC, V, HF, T, S>::k_no_parent;
+
+template <std::size_t FB, std::size_t IC, typename V, template <typename...> class HF, typename T, typename S>
+constexpr size_t cuckoo_hash_table<FB, IC, V, HF, T, S>::k_bucket_alignment;
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t FB,                     \
+        std::size_t IC,                     \
+        typename V,                         \
+        template <typename...> class HF,    \
+        typename T,                         \
+        typename S>                         \
+    __VA_ARGS__ cuckoo_hash_table<FB, IC, V, HF, T, S>::method_name
+
+CLASS_METHOD_IMPL(cuckoo_hash_table, )
+(size_t num_buckets, size_t max_kicks) : hash_factory_(std::make_unique<HF<T, S>>()),
+                                         buckets_(cuckoo_table<FB, IC, S>::round_up(num_buckets)),
+                                         k_max_kicks_(max_kicks),
+                                         num_items_(0) {
+    static_assert(sizeof(S) * 8 >= FB, "Fingerprint size is larger than hash size");
+    hash_ = hash_factory_->create_hash();
+}
+
+CLASS_METHOD_IMPL(cuckoo_hash_table, )
+(size_t num_buckets, size_t max_kicks, S seed) : hash_factory_(std::make_unique<HF<T, S>>()),
+                                                 buckets_(cuckoo_table<FB, IC, S>::round_up(num_buckets)),
+                                                 k_max_kicks_(max_kicks),
+                                                 num_items_(0) {
+    static_assert(sizeof(S) * 8 >= FB, "Fingerprint size is larger than hash size");
+    hash_ = hash_factory_->create_hash(seed);
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item, const V& value) {
+    if (!try_insert(item, value)) {
+        throw capacity_exceeded_exception();
+    }
+}
+
+CLASS_METHOD_IMPL(try_insert, bool)
+(const T& item, const V& value) {
+    size_t index;
+    S finger_print;
+    locate(item, index, finger_print);
+    size_t bucket;
+    size_t slot;
+    if (find_entry(index, finger_print, bucket, slot)) {
+        buckets_[bucket].values[slot] = value;
+        return true;
+    }
+    size_t alternate = alternate_index(index, finger_print);
+    for (size_t candidate : {index, alternate}) {
+        slot = buckets_[candidate].finger_prints.find(0);
+        if (slot < IC) {
+            buckets_[candidate].finger_prints.set(slot, finger_print);
+            buckets_[candidate].values[slot] = value;
+            ++num_items_;
+            return true;
+        }
+    }
+    if (!evict(index, alternate, finger_print, value)) {
+        return false;
+    }
+    ++num_items_;
+    return true;
+}
+
+CLASS_METHOD_IMPL(find, bool)
+(const T& item, V& value) const {
+    size_t index;
+    S finger_print;
+    locate(item, index, finger_print);
+    size_t bucket;
+    size_t slot;
+    if (!find_entry(index, finger_print, bucket, slot)) {
+        return false;
+    }
+    value = buckets_[bucket].values[slot];
+    return true;
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(const T& item) const {
+    size_t index;
+    S finger_print;
+    locate(item, index, finger_print);
+    size_t bucket;
+    size_t slot;
+    return find_entry(index, finger_print, bucket, slot);
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(const T& item) {
+    size_t index;
+    S finger_print;
+    locate(item, index, finger_print);
+    size_t bucket;
+    size_t slot;
+    if (find_entry(index, finger_print, bucket, slot)) {
+        buckets_[bucket].finger_prints.set(slot, 0);
+        buckets_[bucket].values[slot] = V();
+        --num_items_;
+    }
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    for (value_bucket& entries : buckets_) {
+        entries.finger_prints.clear();
+        std::fill(entries.values, entries.values + IC, V());
+    }
+    num_items_ = 0;
+}
+
+CLASS_METHOD_IMPL(find_entry, bool)
+(size_t index, S finger_print, size_t& bucket, size_t& slot) const {
+    bucket = index;
+    slot = buckets_[bucket].finger_prints.find(finger_print);
+    if (slot < IC) {
+        return true;
+    }
+    bucket = alternate_index(index, finger_print);
+    slot = buckets_[bucket].finger_prints.find(finger_print);
+    return slot < IC;
+}
+
+CLASS_METHOD_IMPL(evict, bool)
+(size_t i, size_t j, S finger_print, const V& value) {
+    std::vector<path_node> nodes;
+    nodes.reserve(k_max_kicks_ + 2);
+    nodes.push_back({i, k_no_parent, 0});
+    nodes.push_back({j, k_no_parent, 0});
+    for (size_t node = 0; node < nodes.size() && nodes.size() < k_max_kicks_ + 2; ++node) {
+        for (size_t slot = 0; slot < IC && nodes.size() < k_max_kicks_ + 2; ++slot) {
+            size_t index = alternate_index(nodes[node].index, buckets_[nodes[node].index].finger_prints.get(slot));
+            bool on_path = false;
+            for (size_t ancestor = node; ancestor != k_no_parent && !on_path; ancestor = nodes[ancestor].parent) {
+                on_path = nodes[ancestor].index == index;
+            }
+            if (on_path) {
+                continue;
+            }
+            nodes.push_back({index, node, slot});
+            size_t free_slot = buckets_[index].finger_prints.find(0);
+            if (free_slot == IC) {
+                continue;
+            }
+            // move entries from the end of the path, each into the slot freed after it
+            for (size_t child = nodes.size() - 1; child != k_no_parent; child = nodes[child].parent) {
+                size_t to = nodes[child].index;
+                if (nodes[child].parent == k_no_parent) {
+                    buckets_[to].finger_prints.set(free_slot, finger_print);
+                    buckets_[to].values[free_slot] = value;
+                    return true;
+                }
+                size_t from = nodes[nodes[child].parent].index;
+                size_t from_slot = nodes[child].slot;
+                buckets_[to].finger_prints.set(free_slot, buckets_[from].finger_prints.get(from_slot));
+                buckets_[to].values[free_slot] = std::move(buckets_[from].values[from_slot]);
+                free_slot = from_slot;
+            }
+        }
+    }
+    return false;
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_TABLE_CUCKOO_HASH_TABLE_H_
@@ -0,0 +1,242 @@
+#ifndef INCLUDE_TABLE_QUOTIENT_HASH_TABLE_H_
+#define INCLUDE_TABLE_QUOTIENT_HASH_TABLE_H_
+
+#include <hash/mmh3_hash_factory.h>
+#include <utils/bits.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "quotient_table.h"
+
+namespace pdstl {
+
+/*! \brief Quotient Hash Table
+ *
+ * quotient_hash_table class implements a compact map from items to small values on top of the
+ * quotient table layout. Items are identified by an F-bit fingerprint of their hash: the
+ * quotient selects the run and each slot packs the remainder followed by the VB-bit value, so
+ * an entry costs (F - Q + VB) bits plus a little over two bits of metadata.
+ *
+ * Like a quotient filter, the table answers for fingerprints, not items: looking up an item
+ * which was not inserted returns the value of an inserted item with the same fingerprint with
+ * probability about size() / 2^F. The table starts with 2^Q slots and expands by taking one
+ * remainder bit into the quotient when it exceeds its maximum load factor.
+ *
+ * \tparam F - Fingerprint bits, must be smaller than or equal to hash output size
+ * \tparam Q - Initial number of bits for quotient part, remainder bit size is (F - Q)
+ * \tparam V - Value type (default: uint32_t)
+ * \tparam VB - Number of bits stored for each value (default: sizeof(V) * 8)
+ * \tparam HF - Hash factory method class (default: pdstl::mmh3_hash_factory)
+ * \tparam T - Element type which will be inserted into quotient hash table (default: std::string)
+ * \tparam S - Hash output type (default: uint32_t)
+ */
+template <
+    std::size_t F,
+    std::size_t Q,
+    typename V = uint32_t,
+    std::size_t VB = sizeof(V) * 8,
+    template <typename...> class HF = mmh3_hash_factory,
+    typename T = std::string,
+    typename S = uint32_t>
+class quotient_hash_table : protected quotient_table<uint64_t, F - Q + VB, true> {
+   protected:
+    typedef quotient_table<uint64_t, F - Q + VB, true> base;
+    using base::count_;
+    using base::get_value;
+    using base::is_occupied;
+    using base::run_start;
+    using base::run_tail;
+    using base::set_value;
+
+    std::unique_ptr<HF<T, S>> hash_factory_;
+    std::unique_ptr<hash<T, S>> hash_;
+    std::size_t quotient_bits_;
+    const float k_max_load_factor_;
+
+    inline S fingerprint(const T& item) const { return static_cast<S>(hash_->value(item) & bitmask(F)); }
+    inline std::size_t quotient(S fingerprint) const { return fingerprint >> (F - quotient_bits_); }
+    inline uint64_t remainder(S fingerprint) const { return fingerprint & bitmask(F - quotient_bits_); }
+
+    //! Finds the slot holding \a remainder in the run of \a key, returns false if there is none
+    bool find_slot(std::size_t key, uint64_t remainder, std::size_t& slot) const;
+
+    //! Rebuilds the table with one more quotient bit
+    void expand();
+
+   public:
+    /*! \brief Default constructor
+     *
+     * \param max_load_factor - fraction of slots in use that triggers expansion (default: 0.95)
+     */
+    explicit quotient_hash_table(float max_load_factor = 0.95f);
+
+    /*! \brief Constructor with a given hash seed
+     *
+     * \param max_load_factor - fraction of slots in use that triggers expansion
+     * \param seed - seed of the hash function
+     */
+    quotient_hash_table(float max_load_factor, S seed);
+
+    /*! \brief Insert an item with its value, or replace the value of an item in the table.
+     *
+     * Only the lowest VB bits of the value are stored.
+     * Throws capacity_exceeded_exception if the table is full and can not expand.
+     *
+     * \param item - the item to insert into the table.
+     * \param value - the value of the item.
+     */
+    void insert(const T& item, V value);
+
+    /*! \brief Look up the value of an item.
+     *
+     * \param item - the item to look up.
+     * \param value - receives the value of the item if it is found.
+     *
+     * \return true if the item (or another item with the same fingerprint) is in the table.
+     */
+    bool find(const T& item, V& value) const;
+
+    /*! \brief Check the item and report that it's in the table or not.
+     *
+     * \param item - the item to check for existence.
+     *
+     * \return false if the item is not in the table, true if item may be in the table.
+     */
+    bool contains(const T& item) const;
+
+    /*! \brief Erase an item with its value from the table.
+     *
+     * Erasing an item which was not inserted may remove another item with the same fingerprint.
+     *
+     * \param item - the item to erase from table.
+     */
+    void erase(const T& item);
+
+    //! \brief Clear table and resets its internal memory.
+    void clear();
+
+    //! \brief Number of items in the table.
+    using base::size;
+
+    //! \brief Number of slots of the table.
+    using base::capacity;
+};
+
+#define CLASS_METHOD_IMPL(method_name, ...) \
+    template <                              \
+        std::size_t F,                      \
+        std::size_t Q,                      \
+        typename V,                         \
+        std::size_t VB,                     \
+        template <typename...> class HF,    \
+        typename T,                         \
+        typename S>                         \
+    __VA_ARGS__ quotient_hash_table<F, Q, V, VB, HF, T, S>::method_name
+
+CLASS_METHOD_IMPL(quotient_hash_table, )
+(float max_load_factor) : base(std::size_t(1) << Q), quotient_bits_(Q), k_max_load_factor_(max_load_factor) {
+    static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
+    static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
+    static_assert(F - Q + VB <= 64, "Remainder and value do not fit in 64 bits");
+    hash_factory_ = std::make_unique<HF<T, S>>();
+    hash_ = hash_factory_->create_hash();
+}
+
+CLASS_METHOD_IMPL(quotient_hash_table, )
+(float max_load_factor, S seed) : base(std::size_t(1) << Q), quotient_bits_(Q), k_max_load_factor_(max_load_factor) {
+    static_assert(sizeof(S) * 8 >= F, "Fingerprint size is larger than hash size");
+    static_assert(F > Q, "Quotient size must be smaller than fingerprint size");
+    static_assert(F - Q + VB <= 64, "Remainder and value do not fit in 64 bits");
+    hash_factory_ = std::make_unique<HF<T, S>>();
+    hash_ = hash_factory_->create_hash(seed);
+}
+
+CLASS_METHOD_IMPL(insert, void)
+(const T& item, V value) {
+    S fp = fingerprint(item);
+    uint64_t entry = (remainder(fp) << VB) | (uint64_t(value) & bitmask(VB));
+    std::size_t slot;
+    if (find_slot(quotient(fp), remainder(fp), slot)) {
+        set_value(slot, entry);
+        return;
+    }
+    if (count_ + 1 > k_max_load_factor_ * base::capacity() && quotient_bits_ + 1 < F) {
+        expand();
+        entry = (remainder(fp) << VB) | (uint64_t(value) & bitmask(VB));
+    }
+    this->insert_value(quotient(fp), entry);
+    ++count_;
+}
+
+CLASS_METHOD_IMPL(find, bool)
+(const T& item, V& value) const {
+    S fp = fingerprint(item);
+    std::size_t slot;
+    if (!find_slot(quotient(fp), remainder(fp), slot)) {
+        return false;
+    }
+    value = static_cast<V>(get_value(slot) & bitmask(VB));
+    return true;
+}
+
+CLASS_METHOD_IMPL(contains, bool)
+(const T& item) const {
+    S fp = fingerprint(item);
+    std::size_t slot;
+    return find_slot(quotient(fp), remainder(fp), slot);
+}
+
+CLASS_METHOD_IMPL(erase, void)
+(const T& item) {
+    S fp = fingerprint(item);
+    std::size_t slot;
+    if (find_slot(quotient(fp), remainder(fp), slot)) {
+        this->erase_slot(quotient(fp), slot);
+        --count_;
+    }
+}
+
+CLASS_METHOD_IMPL(clear, void)
+() {
+    base::operator=(base(std::size_t(1) << Q));
+    quotient_bits_ = Q;
+}
+
+CLASS_METHOD_IMPL(find_slot, bool)
+(std::size_t key, uint64_t remainder, std::size_t& slot) const {
+    if (!is_occupied(key)) {
+        return false;
+    }
+    std::size_t end = run_tail(key);
+    for (slot = run_start(key); slot < end; ++slot) {
+        uint64_t slot_remainder = get_value(slot) >> VB;
+        if (slot_remainder == remainder) {
+            return true;
+        }
+        if (slot_remainder > remainder) {
+            break;
+        }
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(expand, void)
+() {
+    std::size_t remainder_bits = F - quotient_bits_ - 1;
+    base expanded(base::capacity() * 2);
+    this->for_each([&expanded, remainder_bits](std::size_t key, uint64_t entry) {
+        uint64_t remainder = entry >> VB;
+        uint64_t moved = ((remainder & bitmask(remainder_bits)) << VB) | (entry & bitmask(VB));
+        expanded.push_back((key << 1) | (remainder >> remainder_bits), moved);
+    });
+    base::operator=(std::move(expanded));
+    ++quotient_bits_;
+}
+
+#undef CLASS_METHOD_IMPL
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_TABLE_QUOTIENT_HASH_TABLE_H_
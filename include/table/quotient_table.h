@@ -1,46 +1,203 @@
 #ifndef INCLUDE_TABLE_QUOTIENT_TEABLE_H_
 #define INCLUDE_TABLE_QUOTIENT_TEABLE_H_
 
+#include <exception/capacity_exceeded.h>
 #include <exception/not_supported.h>
+#include <io/serialization.h>
+#include <utils/bits.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <iterator>
 #include <memory>
+#include <ostream>
+#include <utility>
 #include <vector>
 
 namespace pdstl {
 
+/*! \brief Block of 64 quotient table slots
+ *
+ * \tparam T - Type of value
+ * \tparam E - Number of bits used for each value
+ * \tparam P - Pack values into E-bit fields instead of storing each one in a T
+ */
+template <typename T, std::size_t E, bool P>
+struct quotient_table_block;
+
+template <typename T, std::size_t E>
+struct quotient_table_block<T, E, false> {
+    static constexpr std::size_t k_slots = 64;
+
+    uint64_t occupieds;
+    uint64_t runends;
+    T values[k_slots];
+
+    inline T get(size_t slot) const { return values[slot]; }
+    inline void set(size_t slot, T value) { values[slot] = value; }
+
+    //! Moves slots [lo - 1, hi - 1] to [lo, hi], slot 0 gets \a carry when \a lo is zero
+    void shift_up(size_t lo, size_t hi, T carry) {
+        if (lo == 0) {
+            std::copy_backward(values, values + hi, values + hi + 1);
+            values[0] = carry;
+        } else if (lo <= hi) {
+            std::copy_backward(values + lo - 1, values + hi, values + hi + 1);
+        }
+    }
+
+    //! Moves slots [lo + 1, hi + 1] to [lo, hi], slot 63 gets \a carry when \a hi is 63
+    void shift_down(size_t lo, size_t hi, T carry) {
+        if (hi == k_slots - 1) {
+            std::copy(values + lo + 1, values + k_slots, values + lo);
+            values[hi] = carry;
+        } else if (lo <= hi) {
+            std::copy(values + lo + 1, values + hi + 2, values + lo);
+        }
+    }
+};
+
+template <typename T, std::size_t E>
+struct quotient_table_block<T, E, true> {
+    static constexpr std::size_t k_slots = 64;
+
+    uint64_t occupieds;
+    uint64_t runends;
+    uint64_t words[E];
+
+    inline T get(size_t slot) const {
+        size_t bit = slot * E;
+        size_t shift = bit % 64;
+        uint64_t value = words[bit / 64] >> shift;
+        if (shift + E > 64) {
+            value |= words[bit / 64 + 1] << (64 - shift);
+        }
+        return static_cast<T>(value & bitmask(E));
+    }
+
+    inline void set(size_t slot, T value) {
+        size_t bit = slot * E;
+        size_t shift = bit % 64;
+        uint64_t field = static_cast<uint64_t>(value) & bitmask(E);
+        uint64_t& low = words[bit / 64];
+        low = (low & ~(bitmask(E) << shift)) | (field << shift);
+        if (shift + E > 64) {
+            uint64_t& high = words[bit / 64 + 1];
+            high = (high & ~bitmask(shift + E - 64)) | (field >> (64 - shift));
+        }
+    }
+
+    //! Moves slots [lo - 1, hi - 1] to [lo, hi], slot 0 gets \a carry when \a lo is zero
+    void shift_up(size_t lo, size_t hi, T carry) {
+        for (size_t slot = hi; slot > lo; --slot) {
+            set(slot, get(slot - 1));
+        }
+        if (lo == 0) {
+            set(0, carry);
+        } else if (lo <= hi) {
+            set(lo, get(lo - 1));
+        }
+    }
+
+    //! Moves slots [lo + 1, hi + 1] to [lo, hi], slot 63 gets \a carry when \a hi is 63
+    void shift_down(size_t lo, size_t hi, T carry) {
+        for (size_t slot = lo; slot < hi; ++slot) {
+            set(slot, get(slot + 1));
+        }
+        if (hi == k_slots - 1) {
+            set(hi, carry);
+        } else if (lo <= hi) {
+            set(hi, get(hi + 1));
+        }
+    }
+};
+
 /*! \brief Quotient Table
  *
  * quotient_table class implements hash table defained in quotient filter algorithm.
- * 
+ *
+ * Slots are grouped into blocks of 64. Each block keeps an occupieds bit vector (bit q is set if
+ * some value with key q is stored), a runends bit vector (bit i is set if slot i holds the last
+ * value of a run) and the values of its slots. An 8-bit offset per block tells where the runs
+ * of the preceding keys end, so runs are located with rank and select on the bit vectors
+ * (rank-and-select quotient filter layout) instead of walking the cluster slot by slot.
+ * Runs never wrap around, a few overflow blocks are allocated after the last key instead.
+ *
+ * With \a P set, values are packed into E-bit fields of 64-bit words, so a slot costs E bits
+ * plus a little over two bits of metadata, instead of sizeof(T) * 8 bits.
+ *
+ * With \a M set, the table is a multiset: a key-value inserted several times takes one slot per
+ * insert, and erase removes one of them.
+ *
  * \tparam T - Type of value
  * \tparam E - Number of bits used for each value (default: sizeof(T) * 8 -3)
+ * \tparam P - Pack values into E-bit fields (default: false)
+ * \tparam M - Keep repeated key-values, once per insert (default: false)
  */
 template <
     typename T,
-    std::size_t E = sizeof(T) * 8 - 3>
+    std::size_t E = sizeof(T) * 8 - 3,
+    bool P = false,
+    bool M = false>
 class quotient_table {
    protected:
-    typedef struct {
-        unsigned char is_occupied : 1;
-        unsigned char is_continuation : 1;
-        unsigned char is_shifted : 1;
-        T value : E;
-        bool is_empty() { return !is_occupied && !is_continuation && !is_shifted; }
-    } bucket;
-
-    typedef struct {
-        size_t start;
-        size_t end;
-    } run;
-
-    inline size_t next(size_t table_idx) const { return (table_idx + 1) % table_.size(); }
-    inline size_t prev(size_t table_idx) const { return (table_.size() + table_idx - 1) % table_.size(); }
-    void shift_right(size_t bucket_index);
-    run find_run(size_t bucket_index) const;
+    static constexpr std::size_t k_block_slots = 64;
+    static constexpr std::size_t k_saturated_offset = 0xFF;
+
+    typedef quotient_table_block<T, E, P> block;
+
+    inline T get_value(size_t slot) const { return blocks_[slot / k_block_slots].get(slot % k_block_slots); }
+    inline void set_value(size_t slot, T value) { blocks_[slot / k_block_slots].set(slot % k_block_slots, value); }
+    inline bool is_occupied(size_t slot) const { return (blocks_[slot / k_block_slots].occupieds >> (slot % k_block_slots)) & 1; }
+    inline bool is_runend(size_t slot) const { return (blocks_[slot / k_block_slots].runends >> (slot % k_block_slots)) & 1; }
+    inline void set_bit(uint64_t& word, size_t slot, bool bit) {
+        uint64_t mask = 1ULL << (slot % k_block_slots);
+        word = bit ? (word | mask) : (word & ~mask);
+    }
+    inline void set_occupied(size_t slot, bool bit) { set_bit(blocks_[slot / k_block_slots].occupieds, slot, bit); }
+    inline void set_runend(size_t slot, bool bit) { set_bit(blocks_[slot / k_block_slots].runends, slot, bit); }
+
+    //! Number of slots at the start of a block used by runs of smaller keys
+    size_t block_offset(size_t block_index) const;
+    //! Position of the \a rank-th runend at or after \a slot
+    size_t select_runend(size_t slot, size_t rank) const;
+    //! Position just after the last run whose key is at most \a slot (not greater than \a slot if there is no such run reaching it)
+    size_t run_tail(size_t slot) const;
+    //! First position of the run of \a key
+    inline size_t run_start(size_t key) const { return key == 0 ? 0 : std::max(key, run_tail(key - 1)); }
+    //! First unused slot at or after \a slot, throws capacity_exceeded_exception if there is none
+    size_t find_unused(size_t slot) const;
+    //! Smallest occupied key greater than \a key, size of the table if there is none
+    size_t next_occupied(size_t key) const;
+    //! Moves slots [from, to) one slot to the right, slot \a to must be unused
+    void shift_right(size_t from, size_t to);
+    //! Moves slots (from, to] one slot to the left, slot \a to becomes unused
+    void shift_left(size_t from, size_t to);
+    //! Recomputes offsets of the blocks in [first_block, last_block]
+    void update_offsets(size_t first_block, size_t last_block);
+    //! Inserts \a value into the run of \a key unless it is there and \a M is not set, returns true if inserted, count is left to the caller
+    bool insert_value(size_t key, T value);
+    //! Removes \a value from the run of \a key, returns true if removed, count is left to the caller
+    bool erase_value(size_t key, T value);
+    //! Inserts \a value at \a slot of the run of \a key, \a slot is in [run start, run tail], count is left to the caller
+    void insert_slot(size_t key, size_t slot, T value);
+    //! Removes \a slot from the run of \a key, count is left to the caller
+    void erase_slot(size_t key, size_t slot);
+    //! Number of blocks of a table with \a size keys
+    static size_t block_count(size_t size) { return (size + static_cast<size_t>(10 * std::sqrt(size))) / k_block_slots + 1; }
+    //! Bytes used by offsets of \a num_blocks blocks, rounded up to keep blocks aligned
+    static size_t offsets_bytes(size_t num_blocks) { return (num_blocks + 7) / 8 * 8; }
 
    protected:
-    std::vector<bucket> table_;
+    size_t size_;
+    size_t count_;
+    size_t num_blocks_;
+    std::vector<block> block_storage_;
+    std::vector<uint8_t> offset_storage_;
+    block* blocks_;
+    uint8_t* offsets_;
 
    public:
     /*! \brief Default constructor
@@ -49,20 +206,83 @@ class quotient_table {
      */
     explicit quotient_table(size_t size);
 
+    /*! \brief Constructs a table on top of external memory, e.g. a memory mapped file.
+     *
+     * The table does not own the memory, which must be 8-byte aligned and hold memory_size(size)
+     * bytes, either zero-filled for an empty table or laid out by a table with the same size.
+     *
+     * \param size - Number of keys in the table
+     * \param memory - memory holding offsets and blocks of the table
+     * \param count - Number of key-values already in \a memory
+     */
+    quotient_table(size_t size, void* memory, size_t count = 0);
+
+    /*! \brief Constructs a table from key-values sorted in ascending (key, value) order.
+     *
+     * The table is laid out in one sequential pass, see push_back.
+     * Throws capacity_exceeded_exception if the key-values do not fit in the table.
+     *
+     * \param size - Number of keys in the table
+     * \param first - iterator to the first std::pair<size_t, T> key-value.
+     * \param last - iterator past the last key-value.
+     */
+    template <typename I>
+    quotient_table(size_t size, I first, I last);
+
+    //! Copy constructor, the copy always owns its memory
+    quotient_table(const quotient_table& other);
+
+    //! Move constructor
+    quotient_table(quotient_table&& other) noexcept;
+
+    //! Assignment operator
+    quotient_table& operator=(quotient_table other) noexcept;
+
+    /*! \brief Bytes of external memory needed by a table
+     *
+     * \param size - Number of keys in the table
+     */
+    static size_t memory_size(size_t size) { return offsets_bytes(block_count(size)) + block_count(size) * sizeof(block); }
+
+    /*! \brief Write the table to a stream in the layout of external memory
+     *
+     * Writes memory_size(capacity()) bytes, which can be read back by load or used in place by
+     * the external memory constructor.
+     *
+     * \param out - the stream to write to.
+     */
+    void save(std::ostream& out) const;
+
+    /*! \brief Read a table written by save from a table with the same number of keys
+     *
+     * Throws invalid_format_exception if the stream is truncated.
+     *
+     * \param in - the stream to read from.
+     * \param count - Number of key-values of the saved table
+     */
+    void load(std::istream& in, size_t count);
+
     /*! \brief insert a key-value in the table
+     *
+     * Inserting a key-value which is in the table does nothing, unless \a M is set.
+     * Throws capacity_exceeded_exception if there is no unused slot left for the value.
      *
      * \param key - the key to insert into the table.
      * \param value - the value to insert into the table
-     * 
+     *
      */
     void insert(size_t key, T value);
 
-    /*! \brief Erase a key from the table.
+    /*! \brief Erase a key-value from the table.
+     *
+     * Erasing a key-value which is not in the table does nothing. With \a M set, one copy of a
+     * repeated key-value is erased.
      *
      * \param key - the key to erase from table.
-     * 
+     * \param value - the value to erase from table.
+     *
      */
-    void erase(size_t key);
+    void erase(size_t key, T value);
 
     //! \brief Clear table and resets its internal memory.
     void clear();
@@ -75,140 +295,461 @@ class quotient_table {
      * \return true if the key-value is in the table, false otherwise.
      */
     bool contains(size_t key, T value) const;
+
+    /*! \brief Append a key-value greater than every key-value in the table.
+     *
+     * Sequential counterpart of insert, used to lay out a table in one pass from key-values
+     * sorted in ascending (key, value) order. Appending the last key-value again does nothing
+     * unless \a M is set, appending a smaller key-value corrupts the table.
+     * Throws capacity_exceeded_exception if there is no unused slot left for the value.
+     *
+     * \param key - the key to append to the table.
+     * \param value - the value to append to the table.
+     */
+    void push_back(size_t key, T value);
+
+    //! \brief Iterator over key-values of the table in ascending (key, value) order.
+    class const_iterator {
+       private:
+        const quotient_table* table_;
+        size_t key_;
+        size_t slot_;
+
+       public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef std::pair<size_t, T> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+        typedef value_type reference;
+
+        const_iterator(const quotient_table* table, size_t key, size_t slot) : table_(table), key_(key), slot_(slot) {}
+
+        value_type operator*() const { return value_type(key_, table_->get_value(slot_)); }
+
+        const_iterator& operator++() {
+            if (!table_->is_runend(slot_)) {
+                ++slot_;
+                return *this;
+            }
+            key_ = table_->next_occupied(key_);
+            slot_ = key_ < table_->size_ ? std::max(slot_ + 1, key_) : 0;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator result = *this;
+            ++(*this);
+            return result;
+        }
+
+        bool operator==(const const_iterator& other) const { return key_ == other.key_ && slot_ == other.slot_; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    };
+
+    //! \brief Iterator to the smallest key-value of the table.
+    const_iterator begin() const {
+        size_t key = is_occupied(0) ? 0 : next_occupied(0);
+        return const_iterator(this, key, key < size_ ? key : 0);
+    }
+
+    //! \brief Iterator past the largest key-value of the table.
+    const_iterator end() const { return const_iterator(this, size_, 0); }
+
+    /*! \brief Visit all key-values of the table in ascending (key, value) order.
+     *
+     * \param visitor - callable invoked as visitor(key, value) for each key-value.
+     */
+    template <typename V>
+    void for_each(V visitor) const;
+
+    //! \brief Number of key-values in the table.
+    size_t size() const { return count_; }
+
+    //! \brief Number of keys of the table.
+    size_t capacity() const { return size_; }
 };
 
-#define CLASS_METHOD_IMPL(method_name, ...) \
-    template <typename T, std::size_t E>    \
-    __VA_ARGS__ quotient_table<T, E>::method_name
+template <typename T, std::size_t E>
+constexpr std::size_t quotient_table_block<T, E, false>::k_slots;
+
+template <typename T, std::size_t E>
+constexpr std::size_t quotient_table_block<T, E, true>::k_slots;
 
-#define CLASS_METHOD_IMPL_TYPED(method_name, ...) \
-    template <typename T, std::size_t E>          \
-    typename quotient_table<T, E>::__VA_ARGS__ quotient_table<T, E>::method_name
+template <typename T, std::size_t E, bool P, bool M>
+constexpr std::size_t quotient_table<T, E, P, M>::k_block_slots;
+
+template <typename T, std::size_t E, bool P, bool M>
+constexpr std::size_t quotient_table<T, E, P, M>::k_saturated_offset;
+
+#define CLASS_METHOD_IMPL(method_name, ...)              \
+    template <typename T, std::size_t E, bool P, bool M> \
+    __VA_ARGS__ quotient_table<T, E, P, M>::method_name
+
+CLASS_METHOD_IMPL(quotient_table, )
+(size_t size) : size_(size),
+                count_(0),
+                num_blocks_(block_count(size)),
+                block_storage_(num_blocks_, block{}),
+                offset_storage_(num_blocks_, 0),
+                blocks_(block_storage_.data()),
+                offsets_(offset_storage_.data()) {
+    static_assert(E > 0 && E <= sizeof(T) * 8 && E <= 64, "Invalid number of bits");
+}
+
+CLASS_METHOD_IMPL(quotient_table, )
+(size_t size, void* memory, size_t count) : size_(size),
+                                            count_(count),
+                                            num_blocks_(block_count(size)),
+                                            blocks_(reinterpret_cast<block*>(static_cast<uint8_t*>(memory) + offsets_bytes(num_blocks_))),
+                                            offsets_(static_cast<uint8_t*>(memory)) {
+    static_assert(E > 0 && E <= sizeof(T) * 8 && E <= 64, "Invalid number of bits");
+}
+
+template <typename T, std::size_t E, bool P, bool M>
+template <typename I>
+quotient_table<T, E, P, M>::quotient_table(size_t size, I first, I last) : quotient_table(size) {
+    for (; first != last; ++first) {
+        push_back(first->first, first->second);
+    }
+}
 
 CLASS_METHOD_IMPL(quotient_table, )
-(size_t size) : table_(std::vector<bucket>(size, {0, 0, 0, 0})) {
-    static_assert(E <= sizeof(T) * 8, "Invalid number of bits");
+(const quotient_table& other) : size_(other.size_),
+                                count_(other.count_),
+                                num_blocks_(other.num_blocks_),
+                                block_storage_(other.blocks_, other.blocks_ + other.num_blocks_),
+                                offset_storage_(other.offsets_, other.offsets_ + other.num_blocks_),
+                                blocks_(block_storage_.data()),
+                                offsets_(offset_storage_.data()) {
+}
+
+CLASS_METHOD_IMPL(quotient_table, )
+(quotient_table&& other) noexcept : size_(other.size_),
+                                    count_(other.count_),
+                                    num_blocks_(other.num_blocks_),
+                                    block_storage_(std::move(other.block_storage_)),
+                                    offset_storage_(std::move(other.offset_storage_)),
+                                    blocks_(other.blocks_),
+                                    offsets_(other.offsets_) {
+}
+
+CLASS_METHOD_IMPL(operator=, quotient_table<T, E, P, M>&)
+(quotient_table other) noexcept {
+    std::swap(size_, other.size_);
+    std::swap(count_, other.count_);
+    std::swap(num_blocks_, other.num_blocks_);
+    block_storage_.swap(other.block_storage_);
+    offset_storage_.swap(other.offset_storage_);
+    std::swap(blocks_, other.blocks_);
+    std::swap(offsets_, other.offsets_);
+    return *this;
 }
 
 CLASS_METHOD_IMPL(insert, void)
 (size_t key, T value) {
-    if (table_[key].is_empty()) {
-        table_[key].value = value;
-        table_[key].is_occupied = 1;
-        return;
+    if (insert_value(key, value)) {
+        ++count_;
     }
-    table_[key].is_occupied = 1;
-    run this_run = find_run(key);
-    if (table_[this_run.start].is_empty()) {
-        table_[this_run.start].value = value;
-        table_[this_run.start].is_shifted = 1;
+}
+
+CLASS_METHOD_IMPL(push_back, void)
+(size_t key, T value) {
+    size_t slot = run_tail(key);
+    bool extends_run = is_occupied(key);
+    if (!M && extends_run && get_value(slot - 1) == value) {
         return;
     }
-    for (size_t run_idx = this_run.start; run_idx != this_run.end; run_idx = next(run_idx)) {
-        if (table_[run_idx].value == value) {
-            return;
-        }
-        if (!table_[run_idx].is_empty() && table_[run_idx].value > value) {
-            if (!table_[run_idx].is_continuation) {
-                table_[run_idx].is_continuation = 1;
-                unsigned char is_shifted = table_[run_idx].is_shifted;
-                shift_right(run_idx);
-                table_[run_idx].value = value;
-                table_[run_idx].is_shifted = is_shifted;
-                table_[run_idx].is_continuation = 0;
-            } else {
-                shift_right(run_idx);
-                table_[run_idx].value = value;
-                table_[run_idx].is_shifted = 1;
-                table_[run_idx].is_continuation = 1;
-            }
-            return;
-        }
+    slot = std::max(slot, key);
+    if (slot >= num_blocks_ * k_block_slots) {
+        throw capacity_exceeded_exception();
+    }
+    if (extends_run) {
+        set_runend(slot - 1, false);
+    } else {
+        set_occupied(key, true);
     }
-    shift_right(this_run.end);
-    table_[this_run.end].value = value;
-    table_[this_run.end].is_shifted = 1;
-    table_[this_run.end].is_continuation = 1;
+    set_value(slot, value);
+    set_runend(slot, true);
+    update_offsets(key / k_block_slots + 1, slot / k_block_slots);
+    ++count_;
 }
 
 CLASS_METHOD_IMPL(erase, void)
-(size_t /* key */) {
-    throw not_supported_exception();
+(size_t key, T value) {
+    if (erase_value(key, value)) {
+        --count_;
+    }
 }
 
 CLASS_METHOD_IMPL(clear, void)
 () {
-    std::for_each(table_.begin(), table_.end(), [](bucket& item) {
-        item.is_occupied = 0;
-        item.is_continuation = 0;
-        item.is_shifted = 0;
-        item.value = 0;
-    });
+    std::fill(blocks_, blocks_ + num_blocks_, block{});
+    std::fill(offsets_, offsets_ + num_blocks_, 0);
+    count_ = 0;
+}
+
+CLASS_METHOD_IMPL(save, void)
+(std::ostream& out) const {
+    const uint8_t padding[8] = {};
+    write_bytes(out, offsets_, num_blocks_);
+    write_bytes(out, padding, offsets_bytes(num_blocks_) - num_blocks_);
+    write_bytes(out, blocks_, num_blocks_ * sizeof(block));
+}
+
+CLASS_METHOD_IMPL(load, void)
+(std::istream& in, size_t count) {
+    uint8_t padding[8];
+    read_bytes(in, offsets_, num_blocks_);
+    read_bytes(in, padding, offsets_bytes(num_blocks_) - num_blocks_);
+    read_bytes(in, blocks_, num_blocks_ * sizeof(block));
+    count_ = count;
 }
 
 CLASS_METHOD_IMPL(contains, bool)
 (size_t key, T value) const {
-    if (!table_[key].is_occupied) {
+    if (!is_occupied(key)) {
         return false;
     }
-    run this_run = find_run(key);
-    for (size_t run_idx = this_run.start; run_idx != this_run.end; run_idx = next(run_idx)) {
-        if (table_[run_idx].value == value) {
+    size_t end = run_tail(key);
+    for (size_t slot = run_start(key); slot < end; ++slot) {
+        T slot_value = get_value(slot);
+        if (slot_value == value) {
             return true;
         }
+        if (slot_value > value) {
+            break;
+        }
     }
     return false;
 }
 
+template <typename T, std::size_t E, bool P, bool M>
+template <typename V>
+void quotient_table<T, E, P, M>::for_each(V visitor) const {
+    size_t slot = 0;
+    for (size_t key = is_occupied(0) ? 0 : next_occupied(0); key < size_; key = next_occupied(key)) {
+        slot = std::max(slot, key);
+        do {
+            visitor(key, get_value(slot));
+        } while (!is_runend(slot++));
+    }
+}
+
+CLASS_METHOD_IMPL(block_offset, size_t)
+(size_t block_index) const {
+    if (offsets_[block_index] < k_saturated_offset) {
+        return offsets_[block_index];
+    }
+    size_t block_start = block_index * k_block_slots;
+    size_t tail = run_tail(block_start - 1);
+    return tail > block_start ? tail - block_start : 0;
+}
+
+CLASS_METHOD_IMPL(select_runend, size_t)
+(size_t slot, size_t rank) const {
+    size_t block_index = slot / k_block_slots;
+    if (block_index >= num_blocks_) {
+        return num_blocks_ * k_block_slots;
+    }
+    uint64_t word = blocks_[block_index].runends & ~bitmask(slot % k_block_slots);
+    while (true) {
+        size_t word_count = popcount(word);
+        if (rank < word_count) {
+            return block_index * k_block_slots + select_bit(word, rank);
+        }
+        rank -= word_count;
+        if (++block_index >= num_blocks_) {
+            return num_blocks_ * k_block_slots;
+        }
+        word = blocks_[block_index].runends;
+    }
+}
+
+CLASS_METHOD_IMPL(run_tail, size_t)
+(size_t slot) const {
+    size_t block_index = slot / k_block_slots;
+    size_t block_start = block_index * k_block_slots;
+    size_t offset = block_offset(block_index);
+    size_t rank = popcount(blocks_[block_index].occupieds & bitmask(slot - block_start + 1));
+    if (rank == 0) {
+        return block_start + offset;
+    }
+    return select_runend(block_start + offset, rank - 1) + 1;
+}
+
+CLASS_METHOD_IMPL(find_unused, size_t)
+(size_t slot) const {
+    size_t num_slots = num_blocks_ * k_block_slots;
+    while (slot < num_slots) {
+        size_t tail = run_tail(slot);
+        if (tail <= slot) {
+            return slot;
+        }
+        slot = tail;
+    }
+    throw capacity_exceeded_exception();
+}
+
+CLASS_METHOD_IMPL(next_occupied, size_t)
+(size_t key) const {
+    ++key;
+    size_t block_index = key / k_block_slots;
+    if (key >= size_) {
+        return size_;
+    }
+    uint64_t word = blocks_[block_index].occupieds & ~bitmask(key % k_block_slots);
+    while (word == 0) {
+        if (++block_index * k_block_slots >= size_) {
+            return size_;
+        }
+        word = blocks_[block_index].occupieds;
+    }
+    return std::min(size_, block_index * k_block_slots + count_trailing_zeros(word));
+}
+
 CLASS_METHOD_IMPL(shift_right, void)
-(size_t bucket_index) {
-    bucket curr = table_[bucket_index];
-    if (curr.is_empty()) {
+(size_t from, size_t to) {
+    if (from >= to) {
         return;
     }
-    size_t next_idx = next(bucket_index);
-    while (true) {
-        if (table_[next_idx].is_empty()) {
-            table_[next_idx].value = curr.value;
-            table_[next_idx].is_continuation = curr.is_continuation;
-            table_[next_idx].is_shifted = 1;
-            break;
-        } else {
-            bucket tmp = table_[next_idx];
-            table_[next_idx].value = curr.value;
-            table_[next_idx].is_continuation = curr.is_continuation;
-            table_[next_idx].is_shifted = 1;
-            curr = tmp;
+    size_t first_block = from / k_block_slots;
+    for (size_t block_index = to / k_block_slots + 1; block_index-- > first_block;) {
+        block& this_block = blocks_[block_index];
+        size_t block_start = block_index * k_block_slots;
+        size_t lo = std::max(from + 1, block_start) - block_start;
+        size_t hi = std::min(to, block_start + k_block_slots - 1) - block_start;
+        uint64_t carry = 0;
+        T carry_value = 0;
+        if (lo == 0) {
+            const block& prev_block = blocks_[block_index - 1];
+            carry = prev_block.runends >> (k_block_slots - 1);
+            carry_value = prev_block.get(k_block_slots - 1);
         }
-        next_idx = next(next_idx);
+        this_block.shift_up(lo, hi, carry_value);
+        uint64_t mask = bitmask(hi + 1) & ~bitmask(lo);
+        this_block.runends = (this_block.runends & ~mask) | (((this_block.runends << 1) | carry) & mask);
     }
 }
 
-CLASS_METHOD_IMPL_TYPED(find_run, run)
-(size_t bucket_index) const {
-    size_t j = bucket_index;
-    for (; table_[j].is_shifted; j = prev(j)) {
+CLASS_METHOD_IMPL(shift_left, void)
+(size_t from, size_t to) {
+    if (from >= to) {
+        set_value(from, 0);
+        set_runend(from, false);
+        return;
     }
-    size_t run_start = j;
-    while (j != bucket_index) {
-        do {
-            run_start = next(run_start);
-        } while (table_[run_start].is_continuation);
+    size_t last_block = to / k_block_slots;
+    for (size_t block_index = from / k_block_slots; block_index <= last_block; ++block_index) {
+        block& this_block = blocks_[block_index];
+        size_t block_start = block_index * k_block_slots;
+        size_t lo = std::max(from, block_start) - block_start;
+        size_t hi = std::min(to, block_start + k_block_slots - 1) - block_start;
+        uint64_t carry = 0;
+        T carry_value = 0;
+        if (block_index < last_block) {
+            const block& next_block = blocks_[block_index + 1];
+            carry = next_block.runends & 1;
+            carry_value = next_block.get(0);
+        }
+        this_block.shift_down(lo, hi, carry_value);
+        uint64_t mask = bitmask(hi + 1) & ~bitmask(lo);
+        this_block.runends = (this_block.runends & ~mask) | (((this_block.runends >> 1) | (carry << (k_block_slots - 1))) & mask);
+    }
+    set_value(to, 0);
+    set_runend(to, false);
+}
 
-        do {
-            j = next(j);
-        } while (!table_[j].is_occupied);
+CLASS_METHOD_IMPL(insert_value, bool)
+(size_t key, T value) {
+    size_t slot = run_start(key);
+    if (is_occupied(key)) {
+        size_t end = run_tail(key);
+        for (; slot < end; ++slot) {
+            T slot_value = get_value(slot);
+            if (slot_value == value && !M) {
+                return false;
+            }
+            if (slot_value >= value) {
+                break;
+            }
+        }
+    }
+    insert_slot(key, slot, value);
+    return true;
+}
+
+CLASS_METHOD_IMPL(erase_value, bool)
+(size_t key, T value) {
+    if (!is_occupied(key)) {
+        return false;
+    }
+    size_t end = run_tail(key);
+    for (size_t slot = run_start(key); slot < end; ++slot) {
+        T slot_value = get_value(slot);
+        if (slot_value == value) {
+            erase_slot(key, slot);
+            return true;
+        }
+        if (slot_value > value) {
+            return false;
+        }
+    }
+    return false;
+}
+
+CLASS_METHOD_IMPL(insert_slot, void)
+(size_t key, size_t slot, T value) {
+    bool new_run = !is_occupied(key);
+    bool at_tail = !new_run && slot == run_tail(key);
+    size_t unused = find_unused(slot);
+    shift_right(slot, unused);
+    set_value(slot, value);
+    if (new_run) {
+        set_runend(slot, true);
+        set_occupied(key, true);
+    } else if (at_tail) {
+        set_runend(slot - 1, false);
+        set_runend(slot, true);
+    } else {
+        set_runend(slot, false);
     }
-    size_t run_end = run_start;
-    do {
-        run_end = next(run_end);
-    } while (table_[run_end].is_continuation);
+    update_offsets(key / k_block_slots + 1, unused / k_block_slots);
+}
 
-    return run{run_start, run_end};
+CLASS_METHOD_IMPL(erase_slot, void)
+(size_t key, size_t slot) {
+    size_t start = run_start(key);
+    size_t end = run_tail(key);
+    // runs after this one move left with it, up to an unused slot or a run starting at its own key
+    size_t stop = end;
+    size_t num_slots = num_blocks_ * k_block_slots;
+    for (size_t next_key = key; stop < num_slots && run_tail(stop) > stop;) {
+        next_key = next_occupied(next_key);
+        if (next_key == stop) {
+            break;
+        }
+        stop = run_tail(next_key);
+    }
+    shift_left(slot, stop - 1);
+    if (start + 1 == end) {
+        set_occupied(key, false);
+    } else if (slot + 1 == end) {
+        set_runend(slot - 1, true);
+    }
+    update_offsets(key / k_block_slots + 1, (stop - 1) / k_block_slots);
+}
+
+CLASS_METHOD_IMPL(update_offsets, void)
+(size_t first_block, size_t last_block) {
+    for (size_t block_index = first_block; block_index <= last_block && block_index < num_blocks_; ++block_index) {
+        size_t block_start = block_index * k_block_slots;
+        size_t tail = run_tail(block_start - 1);
+        size_t offset = tail > block_start ? tail - block_start : 0;
+        offsets_[block_index] = static_cast<uint8_t>(std::min<size_t>(offset, k_saturated_offset));
+    }
 }
 
 #undef CLASS_METHOD_IMPL
-#undef CLASS_METHOD_IMPL_TYPED
 
 }   // namespace pdstl
 
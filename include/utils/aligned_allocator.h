@@ -0,0 +1,78 @@
+#ifndef INCLUDE_UTILS_ALIGNED_ALLOCATOR_H_
+#define INCLUDE_UTILS_ALIGNED_ALLOCATOR_H_
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+
+namespace pdstl {
+
+//! Bytes of a cache line
+constexpr std::size_t k_cache_line_size = 64;
+
+/*! \brief Alignment which keeps an object of \a bytes bytes inside one cache line
+ *
+ * The smallest power of two of at least \a bytes and \a min_alignment, at most a cache line, so
+ * objects of at most a cache line laid out at this alignment never straddle two lines.
+ */
+constexpr std::size_t cache_line_alignment(std::size_t bytes, std::size_t min_alignment) {
+    std::size_t alignment = min_alignment;
+    while (alignment < bytes && alignment < k_cache_line_size) {
+        alignment *= 2;
+    }
+    return alignment;
+}
+
+/*! \brief Aligned Allocator
+ *
+ * aligned_allocator class allocates memory aligned to \a A bytes, e.g. to lay out containers
+ * of cache line aligned types, whose alignment operator new ignores before C++17.
+ *
+ * \tparam T - Type of allocated objects
+ * \tparam A - Alignment in bytes, a power of two
+ */
+template <typename T, std::size_t A>
+class aligned_allocator {
+   public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef aligned_allocator<U, A> other;
+    };
+
+    aligned_allocator() = default;
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, A>& /* other */) {}
+
+    //! Allocates uninitialized memory for \a count objects, throws std::bad_alloc on failure
+    T* allocate(std::size_t count) {
+        void* memory = nullptr;
+        if (count > std::numeric_limits<std::size_t>::max() / sizeof(T) ||
+            ::posix_memalign(&memory, std::max(A, sizeof(void*)), count * sizeof(T)) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(memory);
+    }
+
+    //! Releases memory of allocate
+    void deallocate(T* memory, std::size_t /* count */) { ::free(memory); }
+};
+
+template <typename T, typename U, std::size_t A>
+bool operator==(const aligned_allocator<T, A>& /* lhs */, const aligned_allocator<U, A>& /* rhs */) {
+    return true;
+}
+
+template <typename T, typename U, std::size_t A>
+bool operator!=(const aligned_allocator<T, A>& /* lhs */, const aligned_allocator<U, A>& /* rhs */) {
+    return false;
+}
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_UTILS_ALIGNED_ALLOCATOR_H_
@@ -0,0 +1,67 @@
+#ifndef INCLUDE_UTILS_BITS_H_
+#define INCLUDE_UTILS_BITS_H_
+
+#include <cstdint>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace pdstl {
+
+//! \brief Mask with the lowest \a n bits set (0 <= n <= 64)
+constexpr uint64_t bitmask(uint64_t n) {
+    return n >= 64 ? ~0ULL : (1ULL << n) - 1;
+}
+
+//! \brief Number of set bits in \a word
+inline uint64_t popcount(uint64_t word) {
+    return __builtin_popcountll(word);
+}
+
+//! \brief Number of trailing zero bits in \a word, 64 if \a word is zero
+inline uint64_t count_trailing_zeros(uint64_t word) {
+    return word ? __builtin_ctzll(word) : 64;
+}
+
+//! \brief Number of leading zero bits in \a word, 64 if \a word is zero
+inline uint64_t count_leading_zeros(uint64_t word) {
+    return word ? __builtin_clzll(word) : 64;
+}
+
+//! \brief High 64 bits of the 128-bit product of \a a and \a b
+inline uint64_t multiply_high(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128_t;
+    return static_cast<uint64_t>((static_cast<uint128_t>(a) * b) >> 64);
+#else
+    uint64_t a_low = a & 0xFFFFFFFF, a_high = a >> 32;
+    uint64_t b_low = b & 0xFFFFFFFF, b_high = b >> 32;
+    uint64_t low = a_low * b_low;
+    uint64_t middle = a_high * b_low + (low >> 32);
+    uint64_t carry = (middle & 0xFFFFFFFF) + a_low * b_high;
+    return a_high * b_high + (middle >> 32) + (carry >> 32);
+#endif
+}
+
+/*! \brief Position of the \a rank-th (0-based) set bit in \a word
+ *
+ * \return bit position, or 64 if \a word has less than \a rank + 1 set bits.
+ */
+inline uint64_t select_bit(uint64_t word, uint64_t rank) {
+    if (rank >= 64) {
+        return 64;
+    }
+#if defined(__BMI2__)
+    return count_trailing_zeros(_pdep_u64(1ULL << rank, word));
+#else
+    for (; rank > 0 && word; --rank) {
+        word &= word - 1;
+    }
+    return count_trailing_zeros(word);
+#endif
+}
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_UTILS_BITS_H_
@@ -0,0 +1,226 @@
+#ifndef INCLUDE_UTILS_PACKED_REGISTERS_H_
+#define INCLUDE_UTILS_PACKED_REGISTERS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "bits.h"
+
+#if defined(__AVX2__) || defined(__AVX512BW__)
+#include <immintrin.h>
+#endif
+
+namespace pdstl {
+
+/*! \brief Vectorised kernels on arrays of small registers, e.g. of HyperLogLog sketches
+ *
+ * Registers are kept either in bytes, or as 6-bit fields packed little-endian, 4 registers in
+ * each 3 bytes. Packed arrays are read and written 8 bytes past their end, which must be
+ * allocated (k_padding). Register counts must be multiples of 4.
+ *
+ * Kernels use AVX-512BW or AVX2 when the compiler targets them (e.g. -mavx2 or -march=native),
+ * and a scalar loop otherwise.
+ */
+namespace packed_registers {
+
+//! Bytes read and written past the end of packed arrays
+constexpr std::size_t k_padding = 8;
+
+//! Bytes of \a count packed 6-bit registers, without padding
+constexpr std::size_t packed_size(std::size_t count) { return count / 4 * 3; }
+
+#if defined(__AVX2__) || defined(__AVX512BW__)
+//! Spreads the 4 6-bit fields of the low 3 bytes of each 32-bit lane into its 4 bytes
+inline __m256i spread(__m256i lanes) {
+    __m256i bytes = _mm256_and_si256(lanes, _mm256_set1_epi32(0x3F));
+    bytes = _mm256_or_si256(bytes, _mm256_and_si256(_mm256_slli_epi32(lanes, 2), _mm256_set1_epi32(0x3F00)));
+    bytes = _mm256_or_si256(bytes, _mm256_and_si256(_mm256_slli_epi32(lanes, 4), _mm256_set1_epi32(0x3F0000)));
+    return _mm256_or_si256(bytes, _mm256_and_si256(_mm256_slli_epi32(lanes, 6), _mm256_set1_epi32(0x3F000000)));
+}
+
+//! Gathers the 4 6-bit registers in the bytes of each 32-bit lane into its low 3 bytes
+inline __m256i gather(__m256i bytes) {
+    __m256i lanes = _mm256_and_si256(bytes, _mm256_set1_epi32(0x3F));
+    lanes = _mm256_or_si256(lanes, _mm256_and_si256(_mm256_srli_epi32(bytes, 2), _mm256_set1_epi32(0xFC0)));
+    lanes = _mm256_or_si256(lanes, _mm256_and_si256(_mm256_srli_epi32(bytes, 4), _mm256_set1_epi32(0x3F000)));
+    return _mm256_or_si256(lanes, _mm256_and_si256(_mm256_srli_epi32(bytes, 6), _mm256_set1_epi32(0xFC0000)));
+}
+
+//! 32 registers from the 24 bytes at \a packed
+inline __m256i load_packed(const uint8_t* packed) {
+    const __m256i k_to_lanes = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    __m256i groups = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(packed))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + 12)), 1);
+    return spread(_mm256_shuffle_epi8(groups, k_to_lanes));
+}
+
+//! Stores 32 registers into the 24 bytes at \a packed, overwriting the 4 bytes after them
+inline void store_packed(uint8_t* packed, __m256i registers) {
+    const __m256i k_to_groups = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    __m256i groups = _mm256_shuffle_epi8(gather(registers), k_to_groups);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(packed), _mm256_castsi256_si128(groups));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(packed + 12), _mm256_extracti128_si256(groups, 1));
+}
+#endif
+
+//! Unpacks the 4 registers of the 3 bytes at \a packed into \a registers
+inline void unpack_group(const uint8_t* packed, uint8_t* registers) {
+    uint32_t group = packed[0] | (uint32_t(packed[1]) << 8) | (uint32_t(packed[2]) << 16);
+    for (std::size_t index = 0; index < 4; ++index) {
+        registers[index] = static_cast<uint8_t>((group >> (6 * index)) & 0x3F);
+    }
+}
+
+//! Packs the 4 registers at \a registers into the 3 bytes at \a packed
+inline void pack_group(const uint8_t* registers, uint8_t* packed) {
+    uint32_t group = 0;
+    for (std::size_t index = 0; index < 4; ++index) {
+        group |= uint32_t(registers[index] & 0x3F) << (6 * index);
+    }
+    packed[0] = static_cast<uint8_t>(group);
+    packed[1] = static_cast<uint8_t>(group >> 8);
+    packed[2] = static_cast<uint8_t>(group >> 16);
+}
+
+/*! \brief Unpack 6-bit registers into bytes
+ *
+ * \param packed - packed registers.
+ * \param registers - \a count bytes receiving the registers.
+ * \param count - number of registers.
+ */
+inline void unpack(const uint8_t* packed, uint8_t* registers, std::size_t count) {
+    std::size_t index = 0;
+#if defined(__AVX2__) || defined(__AVX512BW__)
+    for (; index + 32 <= count; index += 32) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(registers + index), load_packed(packed + index / 4 * 3));
+    }
+#endif
+    for (; index < count; index += 4) {
+        unpack_group(packed + index / 4 * 3, registers + index);
+    }
+}
+
+/*! \brief Pack bytes into 6-bit registers
+ *
+ * \param registers - \a count bytes holding registers smaller than 64.
+ * \param packed - packed registers.
+ * \param count - number of registers.
+ */
+inline void pack(const uint8_t* registers, uint8_t* packed, std::size_t count) {
+    std::size_t index = 0;
+#if defined(__AVX2__) || defined(__AVX512BW__)
+    for (; index + 32 <= count; index += 32) {
+        store_packed(packed + index / 4 * 3, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(registers + index)));
+    }
+    std::memset(packed + packed_size(count), 0, k_padding);
+#endif
+    for (; index < count; index += 4) {
+        pack_group(registers + index, packed + index / 4 * 3);
+    }
+}
+
+/*! \brief Raise byte registers to the maximum of themselves and other byte registers
+ *
+ * \param accumulator - \a count byte registers, receiving the maxima.
+ * \param registers - \a count byte registers.
+ * \param count - number of registers.
+ */
+inline void max_bytes(uint8_t* accumulator, const uint8_t* registers, std::size_t count) {
+    std::size_t index = 0;
+#if defined(__AVX512BW__)
+    for (; index + 64 <= count; index += 64) {
+        __m512i maximum = _mm512_max_epu8(_mm512_loadu_si512(accumulator + index), _mm512_loadu_si512(registers + index));
+        _mm512_storeu_si512(accumulator + index, maximum);
+    }
+#endif
+#if defined(__AVX2__) || defined(__AVX512BW__)
+    for (; index + 32 <= count; index += 32) {
+        __m256i maximum = _mm256_max_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator + index)),
+                                          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(registers + index)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulator + index), maximum);
+    }
+#endif
+    for (; index < count; ++index) {
+        accumulator[index] = std::max(accumulator[index], registers[index]);
+    }
+}
+
+/*! \brief Raise byte registers to the maximum of themselves and packed 6-bit registers
+ *
+ * \param accumulator - \a count byte registers, receiving the maxima.
+ * \param packed - packed registers.
+ * \param count - number of registers.
+ */
+inline void max_packed(uint8_t* accumulator, const uint8_t* packed, std::size_t count) {
+    std::size_t index = 0;
+#if defined(__AVX2__) || defined(__AVX512BW__)
+    for (; index + 32 <= count; index += 32) {
+        __m256i maximum = _mm256_max_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator + index)),
+                                          load_packed(packed + index / 4 * 3));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulator + index), maximum);
+    }
+#endif
+    for (; index < count; index += 4) {
+        const uint8_t* group = packed + index / 4 * 3;
+        uint32_t registers = group[0] | (uint32_t(group[1]) << 8) | (uint32_t(group[2]) << 16);
+        for (std::size_t offset = 0; offset < 4; ++offset, registers >>= 6) {
+            accumulator[index + offset] = std::max(accumulator[index + offset], static_cast<uint8_t>(registers & 0x3F));
+        }
+    }
+}
+
+/*! \brief Compute statistics of byte registers for cardinality estimates
+ *
+ * \param registers - \a count byte registers, smaller than 64.
+ * \param count - number of registers.
+ * \param saturated - value of saturated registers.
+ * \param num_empty - [out] number of zero registers.
+ * \param num_saturated - [out] number of saturated registers.
+ * \param sum - [out] sum of 2^-register of all registers.
+ */
+inline void statistics(const uint8_t* registers, std::size_t count, uint8_t saturated, std::size_t& num_empty, std::size_t& num_saturated, double& sum) {
+    std::size_t index = 0;
+    num_empty = 0;
+    num_saturated = 0;
+    sum = 0;
+#if defined(__AVX2__) || defined(__AVX512BW__)
+    // 2^-register built as a double with exponent 1023 - register, registers are too small to underflow
+    const __m256i k_zero = _mm256_setzero_si256();
+    const __m256i k_saturated = _mm256_set1_epi8(static_cast<char>(saturated));
+    const __m256i k_exponent_bias = _mm256_set1_epi64x(1023);
+    __m256d sums[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    for (; index + 32 <= count; index += 32) {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(registers + index));
+        num_empty += popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(values, k_zero))));
+        num_saturated += popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(values, k_saturated))));
+        for (std::size_t part = 0; part < 8; ++part) {
+            int32_t four;
+            std::memcpy(&four, registers + index + part * 4, sizeof(four));
+            __m256i exponents = _mm256_sub_epi64(k_exponent_bias, _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(four)));
+            sums[part % 4] = _mm256_add_pd(sums[part % 4], _mm256_castsi256_pd(_mm256_slli_epi64(exponents, 52)));
+        }
+    }
+    double parts[4];
+    _mm256_storeu_pd(parts, _mm256_add_pd(_mm256_add_pd(sums[0], sums[1]), _mm256_add_pd(sums[2], sums[3])));
+    sum = parts[0] + parts[1] + parts[2] + parts[3];
+#endif
+    for (; index < count; ++index) {
+        num_empty += registers[index] == 0;
+        num_saturated += registers[index] == saturated;
+        sum += std::ldexp(1.0, -registers[index]);
+    }
+}
+
+}   // namespace packed_registers
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_UTILS_PACKED_REGISTERS_H_
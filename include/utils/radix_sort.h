@@ -0,0 +1,52 @@
+#ifndef INCLUDE_UTILS_RADIX_SORT_H_
+#define INCLUDE_UTILS_RADIX_SORT_H_
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace pdstl {
+
+/*! \brief Sort unsigned integers in ascending order with a least significant digit radix sort
+ *
+ * Runs one counting pass per byte of U, in O(n) time and n extra elements of memory. Passes
+ * on bytes which are equal in all values (e.g. above the fingerprint bits) are skipped.
+ *
+ * \param values - the values to sort.
+ */
+template <typename U>
+void radix_sort(std::vector<U>& values) {
+    static_assert(std::is_unsigned<U>::value, "Radix sort needs unsigned integers");
+    constexpr std::size_t k_digit_bits = 8;
+    constexpr std::size_t k_radix = std::size_t(1) << k_digit_bits;
+    constexpr std::size_t k_passes = sizeof(U);
+
+    std::array<std::array<std::size_t, k_radix>, k_passes> counts{};
+    for (U value : values) {
+        for (std::size_t pass = 0; pass < k_passes; ++pass) {
+            ++counts[pass][(value >> (pass * k_digit_bits)) & (k_radix - 1)];
+        }
+    }
+    std::vector<U> buffer(values.size());
+    for (std::size_t pass = 0; pass < k_passes; ++pass) {
+        std::size_t shift = pass * k_digit_bits;
+        if (values.empty() || counts[pass][(values.front() >> shift) & (k_radix - 1)] == values.size()) {
+            continue;
+        }
+        std::size_t position = 0;
+        for (std::size_t& count : counts[pass]) {
+            std::size_t digit_count = count;
+            count = position;
+            position += digit_count;
+        }
+        for (U value : values) {
+            buffer[counts[pass][(value >> shift) & (k_radix - 1)]++] = value;
+        }
+        values.swap(buffer);
+    }
+}
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_UTILS_RADIX_SORT_H_
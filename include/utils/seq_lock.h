@@ -0,0 +1,65 @@
+#ifndef INCLUDE_UTILS_SEQ_LOCK_H_
+#define INCLUDE_UTILS_SEQ_LOCK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace pdstl {
+
+/*! \brief Sequence lock
+ *
+ * seq_lock class is a version counter which writers lock by making it odd and unlock by making
+ * it even again. Readers do not write to it: they read the version before and after reading
+ * the guarded data, and retry if it was odd or has changed, so reads scale with cores as long
+ * as writes are rare. The guarded data must be read with acquire loads and written with release
+ * stores. Writers meet the Lockable requirements and work with std::lock_guard.
+ */
+class seq_lock {
+   private:
+    std::atomic<uint32_t> version_;
+
+   public:
+    seq_lock() : version_(0) {}
+
+    seq_lock(const seq_lock&) = delete;
+    seq_lock& operator=(const seq_lock&) = delete;
+
+    //! \brief Acquire the lock for writing, waiting until it is released by its holder
+    void lock() {
+        uint32_t version = version_.load(std::memory_order_relaxed);
+        while ((version & 1) || !version_.compare_exchange_weak(version, version + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            std::this_thread::yield();
+            version = version_.load(std::memory_order_relaxed);
+        }
+    }
+
+    //! \brief Acquire the lock for writing if it is free, returns true on success
+    bool try_lock() {
+        uint32_t version = version_.load(std::memory_order_relaxed);
+        return !(version & 1) && version_.compare_exchange_strong(version, version + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    //! \brief Release the lock, publishing the writes made under it
+    void unlock() { version_.fetch_add(1, std::memory_order_release); }
+
+    //! \brief Wait until no writer holds the lock and return the version to validate reads with
+    uint32_t read_begin() const {
+        uint32_t version = version_.load(std::memory_order_acquire);
+        while (version & 1) {
+            std::this_thread::yield();
+            version = version_.load(std::memory_order_acquire);
+        }
+        return version;
+    }
+
+    //! \brief Whether a writer took the lock since read_begin returned \a version
+    bool read_retry(uint32_t version) const {
+        // the acquire loads of the data keep this load after them
+        return version_.load(std::memory_order_relaxed) != version;
+    }
+};
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_UTILS_SEQ_LOCK_H_
@@ -0,0 +1,43 @@
+#ifndef INCLUDE_UTILS_SPIN_LOCK_H_
+#define INCLUDE_UTILS_SPIN_LOCK_H_
+
+#include <atomic>
+#include <thread>
+
+namespace pdstl {
+
+/*! \brief Spin lock
+ *
+ * spin_lock class is a one byte lock for short critical sections. Waiting threads spin on a
+ * plain load and yield, so they do not keep the cache line bouncing between cores. It meets
+ * the Lockable requirements and works with std::lock_guard and std::unique_lock.
+ */
+class spin_lock {
+   private:
+    std::atomic<bool> locked_;
+
+   public:
+    spin_lock() : locked_(false) {}
+
+    spin_lock(const spin_lock&) = delete;
+    spin_lock& operator=(const spin_lock&) = delete;
+
+    //! \brief Acquire the lock, waiting until it is released by its holder
+    void lock() {
+        while (locked_.exchange(true, std::memory_order_acquire)) {
+            while (locked_.load(std::memory_order_relaxed)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    //! \brief Acquire the lock if it is free, returns true on success
+    bool try_lock() { return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire); }
+
+    //! \brief Release the lock
+    void unlock() { locked_.store(false, std::memory_order_release); }
+};
+
+}   // namespace pdstl
+
+#endif   // INCLUDE_UTILS_SPIN_LOCK_H_
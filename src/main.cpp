@@ -1,13 +1,27 @@
 #include <hash/mmh3_hash_factory.h>
+#include <membership/binary_fuse_filter.h>
 #include <membership/bloom_filter.h>
 #include <membership/bloom_filter_calculator.h>
+#include <membership/concurrent_cuckoo_filter.h>
+#include <membership/concurrent_quotient_filter.h>
 #include <membership/counting_bloom_filter.h>
+#include <membership/counting_quotient_filter.h>
 #include <membership/cuckoo_filter.h>
+#include <membership/dynamic_cuckoo_filter.h>
 #include <membership/quotient_filter.h>
+#include <membership/ribbon_filter.h>
+#include <table/cuckoo_hash_table.h>
+#include <table/quotient_hash_table.h>
+#include <utils/packed_registers.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <random>
+#include <sstream>
 #include <string>
+#include <vector>
 class MyCustomClass {
    public:
     std::string first_name;
@@ -100,7 +114,98 @@ int main(int /* argc */, char** /*argv*/) {
     }
 
     pdstl::quotient_filter<16, 4> a_quotient_filter;
-    pdstl::cuckoo_filter<pdstl::cuckoo_table<4, 4, uint8_t>> a_cuckoo_filter(32, 1000);
+    std::for_each(urls.begin(), urls.end(), [&a_quotient_filter](const std::string& item) {
+        a_quotient_filter.insert(item);
+    });
+    if (a_quotient_filter.contains(urls[0])) {
+        std::cout << "FOUND" << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+    a_quotient_filter.erase(urls[0]);
+    if (a_quotient_filter.contains(urls[0])) {
+        std::cout << "FOUND!!!!!" << std::endl;
+    } else {
+        std::cout << "NOT FOUND" << std::endl;
+    }
+
+    // with 16-bit fingerprints some of 3000 items collide, erasing half of them keeps the others
+    pdstl::quotient_filter<16, 12, pdstl::mmh3_hash_factory, uint32_t> colliding_quotient_filter(0.95f, 42);
+    for (uint32_t item = 0; item < 3000; ++item) {
+        colliding_quotient_filter.insert(item);
+    }
+    for (uint32_t item = 0; item < 1500; ++item) {
+        colliding_quotient_filter.erase(item);
+    }
+    for (uint32_t item = 1500; item < 3000; ++item) {
+        if (!colliding_quotient_filter.contains(item)) {
+            std::cout << "quotient filter lost " << item << " after erasing another item" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "quotient filter kept all items after erasing colliding ones" << std::endl;
+
+    pdstl::quotient_filter<16, 4> bulk_quotient_filter(urls.begin(), urls.end());
+    if (bulk_quotient_filter.contains(urls[1])) {
+        std::cout << "FOUND" << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+
+    std::stringstream saved_quotient_filter;
+    bulk_quotient_filter.save(saved_quotient_filter);
+    auto loaded_quotient_filter = pdstl::quotient_filter<16, 4>::load(saved_quotient_filter);
+    if (loaded_quotient_filter.contains(urls[1])) {
+        std::cout << "FOUND" << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+
+    pdstl::counting_quotient_filter<16, 4> a_counting_quotient_filter;
+    std::for_each(urls.begin(), urls.end(), [&a_counting_quotient_filter](const std::string& item) {
+        a_counting_quotient_filter.insert(item);
+    });
+    a_counting_quotient_filter.insert(urls[0]);
+    std::cout << urls[0] << " count: " << a_counting_quotient_filter.count(urls[0]) << std::endl;
+    a_counting_quotient_filter.erase(urls[0]);
+    std::cout << urls[0] << " count: " << a_counting_quotient_filter.count(urls[0]) << std::endl;
+
+    pdstl::concurrent_quotient_filter<16, 8> a_concurrent_quotient_filter;
+    {
+        decltype(a_concurrent_quotient_filter)::insert_buffer buffer(a_concurrent_quotient_filter);
+        std::for_each(urls.begin(), urls.end(), [&buffer](const std::string& item) {
+            buffer.insert(item);
+        });
+    }
+    if (a_concurrent_quotient_filter.contains(urls[0])) {
+        std::cout << "FOUND" << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+
+    pdstl::quotient_hash_table<32, 4, uint16_t> a_quotient_hash_table;
+    for (size_t index = 0; index < urls.size(); ++index) {
+        a_quotient_hash_table.insert(urls[index], static_cast<uint16_t>(index));
+    }
+    uint16_t url_index;
+    if (a_quotient_hash_table.find(urls[2], url_index)) {
+        std::cout << urls[2] << " index: " << url_index << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+
+    pdstl::cuckoo_hash_table<32, 4, size_t> a_cuckoo_hash_table(16, 100);
+    for (size_t index = 0; index < urls.size(); ++index) {
+        a_cuckoo_hash_table.insert(urls[index], index);
+    }
+    size_t url_position;
+    if (a_cuckoo_hash_table.find(urls[2], url_position)) {
+        std::cout << urls[2] << " position: " << url_position << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+
+    pdstl::cuckoo_filter<pdstl::cuckoo_table<12, 4, uint16_t>> a_cuckoo_filter(32, 1000);
     std::for_each(urls.begin(), urls.end(), [&a_cuckoo_filter](const std::string& item) {
         a_cuckoo_filter.insert(item);
     });
@@ -109,10 +214,105 @@ int main(int /* argc */, char** /*argv*/) {
     } else {
         std::cout << "NOT FOUND!!!!!" << std::endl;
     }
+    std::vector<bool> found = a_cuckoo_filter.contains(urls.cbegin(), urls.cend());
+    std::cout << "cuckoo filter batch lookup found " << std::count(found.cbegin(), found.cend(), true) << " of " << urls.size() << std::endl;
     a_cuckoo_filter.erase(urls[0]);
     if (a_cuckoo_filter.contains(urls[0])) {
         std::cout << "FOUND!!!!!" << std::endl;
     } else {
         std::cout << "NOT FOUND" << std::endl;
     }
+    std::stringstream saved_cuckoo_filter;
+    a_cuckoo_filter.save(saved_cuckoo_filter);
+    auto loaded_cuckoo_filter = decltype(a_cuckoo_filter)::load(saved_cuckoo_filter);
+    std::cout << "loaded cuckoo filter size: " << loaded_cuckoo_filter.size() << std::endl;
+
+    pdstl::concurrent_cuckoo_filter<pdstl::cuckoo_table<12, 4, uint16_t>> a_concurrent_cuckoo_filter(32, 1000);
+    std::for_each(urls.begin(), urls.end(), [&a_concurrent_cuckoo_filter](const std::string& item) {
+        a_concurrent_cuckoo_filter.insert(item);
+    });
+    if (a_concurrent_cuckoo_filter.contains(urls[0])) {
+        std::cout << "FOUND" << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+
+    pdstl::dynamic_cuckoo_filter<pdstl::cuckoo_table<12, 4, uint16_t>> a_dynamic_cuckoo_filter(1, 100);
+    std::for_each(urls.begin(), urls.end(), [&a_dynamic_cuckoo_filter](const std::string& item) {
+        a_dynamic_cuckoo_filter.insert(item);
+    });
+    std::cout << "dynamic cuckoo filter segments: " << a_dynamic_cuckoo_filter.num_segments() << std::endl;
+    if (a_dynamic_cuckoo_filter.contains(urls[0])) {
+        std::cout << "FOUND" << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+
+    pdstl::binary_fuse_filter<8> a_binary_fuse_filter(urls.begin(), urls.end());
+    if (a_binary_fuse_filter.contains(urls[0])) {
+        std::cout << "FOUND" << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+    a_binary_fuse_filter.clear();
+    std::size_t cleared_binary_fuse_filter_hits = 0;
+    for (std::size_t index = 0; index < 10000; ++index) {
+        cleared_binary_fuse_filter_hits += a_binary_fuse_filter.contains(std::to_string(index)) ? 1 : 0;
+    }
+    std::cout << "cleared binary fuse filter found " << cleared_binary_fuse_filter_hits << " of 10000"
+              << (cleared_binary_fuse_filter_hits == 0 ? "" : "!!!!!") << std::endl;
+
+    size_t number_of_result_bits, number_of_slots;
+    pdstl::ribbon_filter_calculator::optimal_params(urls.size(), 0.01f, number_of_result_bits, number_of_slots);
+    std::cout << "ribbon filter result bits: " << number_of_result_bits << ", slots: " << number_of_slots << std::endl;
+    pdstl::ribbon_filter<7, true> a_ribbon_filter(urls.begin(), urls.end());
+    if (a_ribbon_filter.contains(urls[0])) {
+        std::cout << "FOUND" << std::endl;
+    } else {
+        std::cout << "NOT FOUND!!!!!" << std::endl;
+    }
+    a_ribbon_filter.clear();
+    std::size_t cleared_ribbon_filter_hits = 0;
+    for (std::size_t index = 0; index < 10000; ++index) {
+        cleared_ribbon_filter_hits += a_ribbon_filter.contains(std::to_string(index)) ? 1 : 0;
+    }
+    std::cout << "cleared ribbon filter found " << cleared_ribbon_filter_hits << " of 10000"
+              << (cleared_ribbon_filter_hits == 0 ? "" : "!!!!!") << std::endl;
+
+    // register kernels, vectorised when built with -Dsimd=avx2, against group by group loops,
+    // for 2^4 registers and counts which are not multiples of the vector width
+    std::mt19937 register_generator(7);
+    for (std::size_t count : {std::size_t(16), std::size_t(1000), std::size_t(16384 + 36)}) {
+        std::vector<uint8_t> registers(count), accumulator(count), expected(count), unpacked(count);
+        std::vector<uint8_t> packed(pdstl::packed_registers::packed_size(count) + pdstl::packed_registers::k_padding);
+        std::vector<uint8_t> expected_packed(packed.size());
+        for (std::size_t index = 0; index < count; ++index) {
+            registers[index] = static_cast<uint8_t>(register_generator() % 64);
+            accumulator[index] = static_cast<uint8_t>(register_generator() % 64);
+        }
+        for (std::size_t index = 0; index < count; index += 4) {
+            pdstl::packed_registers::pack_group(registers.data() + index, expected_packed.data() + index / 4 * 3);
+        }
+        pdstl::packed_registers::pack(registers.data(), packed.data(), count);
+        pdstl::packed_registers::unpack(packed.data(), unpacked.data(), count);
+        for (std::size_t index = 0; index < count; ++index) {
+            expected[index] = std::max(accumulator[index], registers[index]);
+        }
+        pdstl::packed_registers::max_packed(accumulator.data(), packed.data(), count);
+        std::size_t num_empty, num_saturated, expected_empty = 0, expected_saturated = 0;
+        double sum, expected_sum = 0;
+        pdstl::packed_registers::statistics(registers.data(), count, 63, num_empty, num_saturated, sum);
+        for (uint8_t value : registers) {
+            expected_empty += value == 0;
+            expected_saturated += value == 63;
+            expected_sum += std::ldexp(1.0, -value);
+        }
+        bool packed_equal = std::equal(expected_packed.begin(), expected_packed.begin() + pdstl::packed_registers::packed_size(count), packed.begin());
+        if (!packed_equal || unpacked != registers || accumulator != expected || num_empty != expected_empty ||
+            num_saturated != expected_saturated || std::abs(sum - expected_sum) > 1e-12 * expected_sum) {
+            std::cout << "register kernels differ from scalar loops on " << count << " registers" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "register kernels match scalar loops" << std::endl;
 }